@@ -7,7 +7,7 @@
 uniform float Radius;
 #define MAX_SIZE 5
 
-vec3 erosion (sampler2D source, vec2 uv, vec2 uv_step, float R) 
+vec3 erosion (vec2 uv, vec2 uv_step, float R) 
 {
     vec3 minValue = vec3(1.0);  
     float D = length(vec2( R / 2.));
@@ -17,7 +17,7 @@ vec3 erosion (sampler2D source, vec2 uv, vec2 uv_step, float R)
         for (float j=-R; j <= R; ++j)
         {
             vec2 delta = vec2(i, j);
-            minValue = min(texture(source, uv + delta * smoothstep(R, D, length(delta)) * uv_step ).rgb, minValue); 
+            minValue = min(texture(iChannel0, uv + delta * smoothstep(R, D, length(delta)) * uv_step ).rgb, minValue); 
         }
     }
 
@@ -35,7 +35,7 @@ void mainImage( out vec4 fragColor, in vec2 fragCoord )
     vec3 c = texture(iChannel1, uv).rgb;
     
     // get result of Closing
-    vec3 e = erosion(iChannel0, uv, 1.0 / iResolution.xy, mix(1., MAX_SIZE, Radius));
+    vec3 e = erosion(uv, 1.0 / iResolution.xy, mix(1., MAX_SIZE, Radius));
 
     // composition
     fragColor = vec4( c + (c-e), 1.0);
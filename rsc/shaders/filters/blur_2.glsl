@@ -5,21 +5,21 @@
  * Distributed under GNU GPL3+ License
 **/
 // Following tutorial https://www.shadertoy.com/view/WtKfD3
-
-#define N 13
+// Number of Taps and Level of details of input are given by BlurFilter
 
 uniform float Radius;
+uniform float Taps;
 
 vec4 blur1D(vec2 U, vec2 D, float rad)
 {
     float w = rad * iResolution.y;
-    float z = ceil(max(0.,log2(w/float(N)))); // LOD  N/w = res/2^z
+    int   n = max(int(Taps), 3);
     vec4  O = vec4(0);
-    float r = float(N-1)/2., g, t=0., x;
-    for( int k=0; k<N; k++ ) {
+    float r = float(n-1)/2., g, t=0., x;
+    for( int k=0; k<n; k++ ) {
         x = float(k)/r -1.;
         t += g = exp(-2.*x*x );
-        O += g * textureLod(iChannel0, (U + w*x*D) / iResolution.xy, z );
+        O += g * texture(iChannel0, (U + w*x*D) / iResolution.xy );
     }
     return O/t;
 }
@@ -20,14 +20,13 @@ uniform float Threshold;
 //  smartDeNoise - parameters
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //
-//  sampler2D tex     - sampler image / texture
 //  vec2 uv           - actual fragment coord
 //  float sigma  >  0 - sigma Standard Deviation
 //  float kSigma >= 0 - sigma coefficient 
 //      kSigma * sigma  -->  radius of the circular kernel
 //  float threshold   - edge sharpening threshold 
 
-vec4 smartDeNoise(sampler2D tex, vec2 uv, float sigma, float kSigma, float threshold)
+vec4 smartDeNoise(vec2 uv, float sigma, float kSigma, float threshold)
 {
     float radius = round(kSigma*sigma);
     float radQ = radius * radius;
@@ -38,11 +37,11 @@ vec4 smartDeNoise(sampler2D tex, vec2 uv, float sigma, float kSigma, float thres
     float invThresholdSqx2 = .5 / (threshold * threshold);     // 1.0 / (sigma^2 * 2.0)
     float invThresholdSqrt2PI = INV_SQRT_OF_2PI / threshold;   // 1.0 / (sqrt(2*PI) * sigma)
     
-    vec4 centrPx = texture(tex,uv);
+    vec4 centrPx = texture(iChannel0, uv);
     
     float zBuff = 0.0;
     vec4 aBuff = vec4(0.0);
-    vec2 size = vec2(textureSize(tex, 0));
+    vec2 size = vec2(textureSize(iChannel0, 0));
     
     for(float x=-radius; x <= radius; x++) {
         float pt = sqrt(radQ-x*x);  // pt = yRadius: have circular trend
@@ -51,7 +50,7 @@ vec4 smartDeNoise(sampler2D tex, vec2 uv, float sigma, float kSigma, float thres
 
             float blurFactor = exp( -dot(d, d) * invSigmaQx2 ) * invSigmaQx2PI;
             
-            vec4 walkPx =  texture(tex,uv+d/size);
+            vec4 walkPx =  texture(iChannel0, uv+d/size);
 
             vec4 dC = walkPx-centrPx;
             float deltaFactor = exp( -dot(dC, dC) * invThresholdSqx2) * invThresholdSqrt2PI * blurFactor;
@@ -67,7 +66,7 @@ void mainImage( out vec4 fragColor, in vec2 fragCoord )
 {
     // Normalized pixel coordinates
     vec2 uv = fragCoord/iResolution.xy;
-    fragColor = smartDeNoise(iChannel0, uv, 2.0, 4.0, mix(0.01, 0.2, Threshold));
+    fragColor = smartDeNoise(uv, 2.0, 4.0, mix(0.01, 0.2, Threshold));
     
 }
 
@@ -7,8 +7,10 @@ layout (location = 2) in vec2 texCoord;
 out vec4 vertexColor;
 out vec2 vertexUV;
 
-uniform mat4 modelview;
-uniform mat4 projection;
+layout (std140) uniform Matrices {
+    mat4 projection;
+    mat4 modelview;
+};
 
 void main()
 {
@@ -5,8 +5,10 @@ layout (location = 1) in vec4 color;
 
 out vec4 vertexColor;
 
-uniform mat4 modelview;
-uniform mat4 projection;
+layout (std140) uniform Matrices {
+    mat4 projection;
+    mat4 modelview;
+};
 
 void main()
 {
@@ -0,0 +1,29 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec4 vertexColor;
+in vec2 vertexUV;
+
+// YUV Shader
+uniform sampler2D iChannel0;        // luma plane (Y)
+uniform sampler2D iChannel1;        // chroma plane (U, or interleaved UV)
+uniform sampler2D iChannel2;        // chroma plane (V), only for 3 planes formats
+uniform int  planes;                // number of planes (2 or 3)
+uniform mat4 yuvtorgb;              // colorimetry and range conversion matrix
+
+void main()
+{
+    // read luma and chroma (chroma planes are sub-sampled)
+    float Y  = texture(iChannel0, vertexUV).r;
+    vec2  UV = texture(iChannel1, vertexUV).rg;
+
+    // with 3 planes, V is in a separate plane (U is red of iChannel1)
+    UV.y = mix( UV.y, texture(iChannel2, vertexUV).r, float(planes > 2) );
+
+    // apply colorimetry matrix
+    vec4 RGB = yuvtorgb * vec4(Y, UV.x, UV.y, 1.0);
+
+    // output opaque RGB
+    FragColor = vec4( clamp(RGB.rgb, 0.0, 1.0), 1.0);
+}
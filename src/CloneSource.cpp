@@ -34,7 +34,46 @@
 
 #include "CloneSource.h"
 
-CloneSource::CloneSource(Source *origin, uint64_t id) : Source(id), origin_(origin), paused_(false), filter_(nullptr)
+bool isTimeFilter(FrameBufferFilter::Type T)
+{
+    return T == FrameBufferFilter::FILTER_DELAY || T == FrameBufferFilter::FILTER_TIMEMACHINE;
+}
+
+bool isFusable(FrameBufferFilter *f)
+{
+    ImageFilter *i = dynamic_cast<ImageFilter *>(f);
+    return i != nullptr && i->program().isPointwise();
+}
+
+FrameBufferFilter *newFilter(FrameBufferFilter::Type T)
+{
+    switch (T)
+    {
+    case FrameBufferFilter::FILTER_DELAY:
+        return new DelayFilter;
+    case FrameBufferFilter::FILTER_RESAMPLE:
+        return new ResampleFilter;
+    case FrameBufferFilter::FILTER_BLUR:
+        return new BlurFilter;
+    case FrameBufferFilter::FILTER_SHARPEN:
+        return new SharpenFilter;
+    case FrameBufferFilter::FILTER_SMOOTH:
+        return new SmoothFilter;
+    case FrameBufferFilter::FILTER_EDGE:
+        return new EdgeFilter;
+    case FrameBufferFilter::FILTER_ALPHA:
+        return new AlphaFilter;
+    case FrameBufferFilter::FILTER_IMAGE:
+        return new ImageFilter;
+    case FrameBufferFilter::FILTER_TIMEMACHINE:
+        return new TimeMachineFilter;
+    default:
+    case FrameBufferFilter::FILTER_PASSTHROUGH:
+        return new PassthroughFilter;
+    }
+}
+
+CloneSource::CloneSource(Source *origin, uint64_t id) : Source(id), origin_(origin), paused_(false)
 {
     // initial name copies the origin name: diplucates are namanged in session
     name_ = origin->name();
@@ -50,7 +89,7 @@ CloneSource::CloneSource(Source *origin, uint64_t id) : Source(id), origin_(orig
     groups_[View::MIXING]->attach(connection_);
 
     // default to pass-through filter
-    filter_ = new PassthroughFilter;
+    filters_.push_back( new PassthroughFilter );
 }
 
 CloneSource::~CloneSource()
@@ -58,7 +97,10 @@ CloneSource::~CloneSource()
     if (origin_)
         origin_->clones_.remove(this);
 
-    delete filter_;
+    for (auto f = fused_.begin(); f != fused_.end(); ++f)
+        delete *f;
+    for (auto f = filters_.begin(); f != filters_.end(); ++f)
+        delete *f;
 }
 
 void CloneSource::detach()
@@ -93,16 +135,28 @@ void CloneSource::render()
     if ( renderbuffer_ == nullptr )
         init();
     else {
-        // render filter image
-        filter_->draw( origin_->frame() );
+        // compile the passes again if a filter changed between pointwise and not
+        std::vector<bool> fusion;
+        for (auto f = filters_.begin(); f != filters_.end(); ++f)
+            fusion.push_back( isFusable(*f) );
+        if ( fusion != fusion_ )
+            compile();
+
+        // render filter images, each pass taking as input the result of the previous
+        FrameBuffer *input = origin_->frame();
+        for (auto p = passes_.begin(); p != passes_.end(); ++p) {
+            (*p)->draw( input );
+            input = (*p)->frame();
+        }
+        FrameBufferFilter *output = passes_.back();
 
         // ensure correct output texture is displayed (could have changed if filter changed)
-        texturesurface_->setTextureIndex( filter_->texture() );
+        texturesurface_->setTextureIndex( output->texture() );
 
         // detect resampling (change of resolution in filter)
-        if ( renderbuffer_->resolution() != filter_->resolution() ) {
-            renderbuffer_->resize( filter_->resolution() );
-//            FrameBuffer *renderbuffer = new FrameBuffer( filter_->resolution(), origin_->frame()->flags() );
+        if ( renderbuffer_->resolution() != output->resolution() ) {
+            renderbuffer_->resize( output->resolution() );
+//            FrameBuffer *renderbuffer = new FrameBuffer( output->resolution(), origin_->frame()->flags() );
 //            attach(renderbuffer);
         }
 
@@ -128,8 +182,10 @@ void CloneSource::setActive (bool on)
             origin_->touch();
 
         // enable / disable filtering
-        if ( active_ != was_active )
-            filter_->setEnabled( active_ );
+        if ( active_ != was_active ) {
+            for (auto f = filters_.begin(); f != filters_.end(); ++f)
+                (*f)->setEnabled( active_ );
+        }
     }
 }
 
@@ -139,8 +195,12 @@ void CloneSource::update(float dt)
 
     if (origin_) {
 
-        if (!paused_ && active_)
-            filter_->update(dt);
+        if (!paused_ && active_) {
+            for (auto f = filters_.begin(); f != filters_.end(); ++f)
+                (*f)->update(dt);
+            for (auto f = fused_.begin(); f != fused_.end(); ++f)
+                (*f)->update(dt);
+        }
 
         // update connection line target to position of origin source
         connection_->target = glm::inverse( GlmToolkit::transform(groups_[View::MIXING]->translation_, glm::vec3(0), groups_[View::MIXING]->scale_) ) *
@@ -148,42 +208,104 @@ void CloneSource::update(float dt)
     }
 }
 
-void CloneSource::setFilter(FrameBufferFilter::Type T)
+void CloneSource::setFilter(FrameBufferFilter::Type T, size_t index)
 {
-    if (filter_)
-        delete filter_;
+    if ( index >= filters_.size() )
+        return;
+
+    // filters of time can only be first in chain
+    if ( index > 0 && isTimeFilter(T) ) {
+        Log::Warning("Source '%s': %s filter can only be first.", name().c_str(),
+                     std::get<2>(FrameBufferFilter::Types[T]).c_str());
+        return;
+    }
 
-    switch (T)
-    {
-    case FrameBufferFilter::FILTER_DELAY:
-        filter_ = new DelayFilter;
-        break;
-    case FrameBufferFilter::FILTER_RESAMPLE:
-        filter_ = new ResampleFilter;
-        break;
-    case FrameBufferFilter::FILTER_BLUR:
-        filter_ = new BlurFilter;
-        break;
-    case FrameBufferFilter::FILTER_SHARPEN:
-        filter_ = new SharpenFilter;
-        break;
-    case FrameBufferFilter::FILTER_SMOOTH:
-        filter_ = new SmoothFilter;
-        break;
-    case FrameBufferFilter::FILTER_EDGE:
-        filter_ = new EdgeFilter;
-        break;
-    case FrameBufferFilter::FILTER_ALPHA:
-        filter_ = new AlphaFilter;
-        break;
-    case FrameBufferFilter::FILTER_IMAGE:
-        filter_ = new ImageFilter;
-        break;
-    default:
-    case FrameBufferFilter::FILTER_PASSTHROUGH:
-        filter_ = new PassthroughFilter;
-        break;
+    delete filters_[index];
+    filters_[index] = newFilter(T);
+
+    compile();
+}
+
+void CloneSource::addFilter(FrameBufferFilter::Type T)
+{
+    // filters of time can only be first in chain
+    if ( isTimeFilter(T) ) {
+        Log::Warning("Source '%s': %s filter can only be first.", name().c_str(),
+                     std::get<2>(FrameBufferFilter::Types[T]).c_str());
+        return;
+    }
+
+    filters_.push_back( newFilter(T) );
+
+    compile();
+}
+
+void CloneSource::removeFilter(size_t index)
+{
+    if ( index >= filters_.size() )
+        return;
+
+    // keep at least a pass-through filter
+    if ( filters_.size() < 2 ) {
+        setFilter( FrameBufferFilter::FILTER_PASSTHROUGH );
+        return;
     }
+
+    delete filters_[index];
+    filters_.erase( filters_.begin() + index );
+
+    compile();
+}
+
+void CloneSource::compile()
+{
+    // delete previously fused filters
+    for (auto f = fused_.begin(); f != fused_.end(); ++f)
+        delete *f;
+    fused_.clear();
+    passes_.clear();
+    fusion_.clear();
+
+    FrameBufferFilter *timefilter = nullptr;
+    std::vector<ImageFilter *> stages;
+
+    // consecutive pointwise filters are applied in a single pass
+    auto fuse = [&]() {
+        if ( stages.size() > 1 ) {
+            FusedFilter *f = new FusedFilter(stages);
+            f->setEnabled( stages.front()->enabled() );
+            fused_.push_back(f);
+            passes_.push_back(f);
+        }
+        else if ( stages.size() > 0 )
+            passes_.push_back(stages.front());
+        stages.clear();
+    };
+
+    for (auto f = filters_.begin(); f != filters_.end(); ++f) {
+        fusion_.push_back( isFusable(*f) );
+
+        // filters of time are applied last: filtering the image before delaying
+        // gives the same result, and next filters get a stable input framebuffer
+        if ( isTimeFilter((*f)->type()) )
+            timefilter = *f;
+        // pointwise filters are fused until a neighborhood operation
+        else if ( fusion_.back() )
+            stages.push_back( dynamic_cast<ImageFilter *>(*f) );
+        // nothing to render for pass-through filter
+        else if ( (*f)->type() != FrameBufferFilter::FILTER_PASSTHROUGH ) {
+            fuse();
+            passes_.push_back(*f);
+        }
+    }
+    fuse();
+
+    if ( timefilter )
+        passes_.push_back(timefilter);
+
+    // at least one pass
+    if ( passes_.empty() )
+        passes_.push_back( filters_.front() );
 }
 
 void CloneSource::play (bool on)
@@ -191,11 +313,12 @@ void CloneSource::play (bool on)
     // if a different state is asked
     if (paused_ == on) {
 
-        // play / pause filter to suspend clone
-        filter_->setEnabled( on );
+        // play / pause filters to suspend clone
+        for (auto f = filters_.begin(); f != filters_.end(); ++f)
+            (*f)->setEnabled( on );
 
         // restart delay if was paused
-        if (paused_ && filter_->type() == FrameBufferFilter::FILTER_DELAY)
+        if (paused_ && isTimeFilter( filters_.front()->type() ) )
             replay();
 
         // toggle state
@@ -205,19 +328,29 @@ void CloneSource::play (bool on)
 
 bool CloneSource::playable () const
 {
-    return filter_->type() != FrameBufferFilter::FILTER_PASSTHROUGH;
+    for (auto f = filters_.begin(); f != filters_.end(); ++f) {
+        if ( (*f)->type() != FrameBufferFilter::FILTER_PASSTHROUGH )
+            return true;
+    }
+    return false;
 }
 
 void CloneSource::replay()
 {
-    // reset Filter
-    filter_->reset();
+    // reset Filters
+    for (auto f = filters_.begin(); f != filters_.end(); ++f)
+        (*f)->reset();
+    for (auto f = fused_.begin(); f != fused_.end(); ++f)
+        (*f)->reset();
 }
 
 guint64 CloneSource::playtime () const
 {
-    if (filter_->type() != FrameBufferFilter::FILTER_PASSTHROUGH)
-        return guint64( filter_->updateTime() * GST_SECOND ) ;
+    // time of the first filter
+    for (auto f = filters_.begin(); f != filters_.end(); ++f) {
+        if ( (*f)->type() != FrameBufferFilter::FILTER_PASSTHROUGH )
+            return guint64( (*f)->updateTime() * GST_SECOND ) ;
+    }
     if (origin_)
         return origin_->playtime();
     return 0;
@@ -2,6 +2,7 @@
 #define CLONESOURCE_H
 
 #include <queue>
+#include <vector>
 
 #include "Source.h"
 #include "FrameBufferFilter.h"
@@ -32,9 +33,12 @@ public:
     void detach();
     inline Source *origin() const { return origin_; }
 
-    // Filtering
-    void setFilter(FrameBufferFilter::Type T);
-    inline FrameBufferFilter *filter() { return filter_; }
+    // Filtering: chain of filters, each applied to the result of the previous
+    void setFilter(FrameBufferFilter::Type T, size_t index = 0);
+    inline FrameBufferFilter *filter(size_t index = 0) const { return index < filters_.size() ? filters_[index] : nullptr; }
+    inline size_t numFilters() const { return filters_.size(); }
+    void addFilter(FrameBufferFilter::Type T);
+    void removeFilter(size_t index);
 
 
 protected:
@@ -50,8 +54,15 @@ protected:
     // connecting line
     class DotLine *connection_;
 
-    // Filter
-    FrameBufferFilter *filter_;
+    // Filters
+    std::vector<FrameBufferFilter *> filters_;
+
+    // passes rendering the chain of filters, with
+    // consecutive pointwise filters fused in one pass
+    std::vector<FrameBufferFilter *> passes_;
+    std::vector<FrameBufferFilter *> fused_;
+    std::vector<bool> fusion_;
+    void compile();
 
 };
 
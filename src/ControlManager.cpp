@@ -33,6 +33,8 @@
 #include "Mixer.h"
 #include "Source.h"
 #include "SourceCallback.h"
+#include "MediaSource.h"
+#include "MediaPlayer.h"
 #include "ImageProcessingShader.h"
 #include "ActionManager.h"
 #include "TransitionView.h"
@@ -605,6 +607,12 @@ bool Control::receiveSourceAttribute(Source *target, const std::string &attribut
         else if ( attribute.compare(OSC_SOURCE_REPLAY) == 0) {
             target->call( new RePlay() );
         }
+        /// e.g. '/vimix/current/preroll'
+        else if ( attribute.compare(OSC_SOURCE_PREROLL) == 0) {
+            MediaSource *ms = dynamic_cast<MediaSource *>(target);
+            if (ms != nullptr)
+                ms->mediaplayer()->preroll();
+        }
         /// e.g. '/vimix/current/alpha f 0.3'
         else if ( attribute.compare(OSC_SOURCE_LOCK) == 0) {
             float x = 1.f;
@@ -864,6 +872,11 @@ bool Control::receiveBatchAttribute(int i, const std::string &attribute,
     bool send_feedback = false;
 
     if ( i < (int) Mixer::manager().session()->numBatch() ) {
+        // e.g. '/vimix/batch#1/preroll' : ask mixer to prepare batch
+        if ( attribute.compare(OSC_SOURCE_PREROLL) == 0) {
+            Mixer::manager().prerollBatch(i);
+            return send_feedback;
+        }
         // Batch sources target: apply attribute to all sources in the Batch
         // loop over batch list of sources
         SourceList _selection = Mixer::manager().session()->getBatch(i);
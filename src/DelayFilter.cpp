@@ -1,14 +1,65 @@
 
+#include <cmath>
+
 #include "Log.h"
 #include "FrameBuffer.h"
+#include "RenderingManager.h"
 #include "Resource.h"
 #include "Primitives.h"
 #include "Visitor.h"
 
 #include "DelayFilter.h"
 
+void DelayFilter::Ring::resize (size_t capacity, glm::vec3 resolution, int flags)
+{
+    // keep the most recent frames in chronological order, others are free
+    const size_t skip = count > capacity ? count - capacity : 0;
+    std::vector<FrameBuffer *> f;
+    std::vector<double> t;
+    std::vector<FrameBuffer *> unused;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if ( i >= skip && i < count ) {
+            f.push_back( frames[index(i)] );
+            t.push_back( times[index(i)] );
+        }
+        else
+            unused.push_back( frames[index(i)] );
+    }
+    count = f.size();
+
+    // fill with free frames or new frames
+    while ( f.size() < capacity ) {
+        if ( !unused.empty() ) {
+            f.push_back( unused.back() );
+            unused.pop_back();
+        }
+        else
+            f.push_back( new FrameBuffer(resolution, flags) );
+        t.push_back( 0. );
+    }
+
+    // delete frames not used anymore
+    for (auto fb = unused.begin(); fb != unused.end(); ++fb)
+        delete *fb;
+
+    frames.swap(f);
+    times.swap(t);
+    first = 0;
+}
+
+void DelayFilter::Ring::clear ()
+{
+    for (auto fb = frames.begin(); fb != frames.end(); ++fb)
+        delete *fb;
+    frames.clear();
+    times.clear();
+    first = 0;
+    count = 0;
+}
+
 DelayFilter::DelayFilter(): FrameBufferFilter(),
-    temp_frame_(nullptr), now_(0.0), delay_(0.5)
+    resolution_(glm::vec3(0.f)), flags_(0), write_(nullptr), output_(nullptr), output_time_(0.0),
+    now_(0.0), delay_(0.5), downscale_(false)
 {
 
 }
@@ -16,91 +67,154 @@ DelayFilter::DelayFilter(): FrameBufferFilter(),
 DelayFilter::~DelayFilter()
 {
     // delete all frame buffers
-    while (!frames_.empty()) {
-        if (frames_.front() != nullptr)
-            delete frames_.front();
-        frames_.pop();
-    }
-
-    while (!elapsed_.empty())
-        elapsed_.pop();
+    recent_.clear();
+    spill_.clear();
 }
 
 void DelayFilter::reset ()
 {
     // delete all frame buffers
-    while (!frames_.empty()) {
-        if (frames_.front() != nullptr)
-            delete frames_.front();
-        frames_.pop();
-    }
-
-    while (!elapsed_.empty())
-        elapsed_.pop();
+    recent_.clear();
+    spill_.clear();
+    write_ = nullptr;
+    output_ = nullptr;
+    output_time_ = 0.0;
 
     now_ = 0.0;
 }
 
 double DelayFilter::updateTime ()
 {
-    if (!elapsed_.empty())
-        return elapsed_.front();
+    if (output_)
+        return output_time_;
 
     return 0.;
 }
 
+bool DelayFilter::allocate (size_t frames)
+{
+    // all frames at full resolution
+    if ( allocate(frames, 0) )
+        return true;
+
+    // not enough memory: older frames at lower resolution (if allowed)
+    if ( downscale_ ) {
+        const double fps = Rendering::manager().frameRate();
+        const size_t n_recent = MIN(frames, (size_t) std::ceil(DELAY_FULL_RESOLUTION * fps) + 1);
+        return allocate(n_recent, frames - n_recent);
+    }
+
+    return false;
+}
+
+bool DelayFilter::allocate (size_t n_recent, size_t n_spill)
+{
+    const glm::vec3 spill_resolution = glm::max( glm::vec3(1.f, 1.f, 0.f),
+                                                 glm::floor(resolution_ / float(DELAY_SPILL_SCALE)) );
+
+    // test for RAM in GPU for the additional frames (always accept the first)
+    const size_t frame_kb = size_t(resolution_.x * resolution_.y) * ((flags_ & FrameBuffer::FrameBuffer_alpha) ? 4 : 3) / 1024;
+    size_t needed_kb = 0;
+    if ( n_recent > recent_.capacity() )
+        needed_kb += (n_recent - recent_.capacity()) * frame_kb;
+    if ( n_spill > spill_.capacity() )
+        needed_kb += (n_spill - spill_.capacity()) * frame_kb / (DELAY_SPILL_SCALE * DELAY_SPILL_SCALE);
+    if ( needed_kb > 0 && recent_.capacity() > 0 && ( !FrameBufferPool::manager().canAllocate(needed_kb) ||
+                            !Rendering::shouldHaveEnoughMemory(resolution_, flags_) ) )
+        return false;
+
+    recent_.resize(n_recent, resolution_, flags_);
+    spill_.resize(n_spill, spill_resolution, flags_);
+
+    return true;
+}
+
 void DelayFilter::update (float dt)
 {
+    write_ = nullptr;
+    output_ = nullptr;
+
     if (input_) {
 
         // What time is it?
         now_ += double(dt) * 0.001;
 
-        // if temporary FBO was pending to be deleted, delete it now
-        if (temp_frame_ != nullptr) {
-            delete temp_frame_;
-            temp_frame_ = nullptr;
+        // restart if input changed (no multisampling or mipmap for stored frames)
+        const int flags = input_->flags() & ~(FrameBuffer::FrameBuffer_multisampling | FrameBuffer::FrameBuffer_mipmap);
+        if ( input_->resolution() != resolution_ || flags != flags_ ) {
+            recent_.clear();
+            spill_.clear();
+            resolution_ = input_->resolution();
+            flags_ = flags;
         }
 
-        // is the total buffer of images longer than delay ?
-        if ( !frames_.empty() && now_ - elapsed_.front() > delay_ )
-        {
-            // remember FBO to be reused if needed (see below) or deleted later
-            temp_frame_ = frames_.front();
+        // number of frames to keep for the delay at the rendering frame rate (with margin)
+        const double fps = Rendering::manager().frameRate();
+        const size_t needed = (size_t) std::ceil(delay_ * fps) + 2;
+        const size_t capacity = recent_.capacity() + spill_.capacity();
 
-            // remove element from queue (front)
-            frames_.pop();
-            elapsed_.pop();
-        }
-
-        // add image to queue to accumulate buffer images until delay reached (with margin)
-        if ( frames_.empty() || now_ - elapsed_.front() < delay_ + ( double(dt) * 0.002) )
-        {
-            // create a FBO if none can be reused (from above) and test for RAM in GPU
-            if (temp_frame_ == nullptr && ( frames_.empty() || Rendering::shouldHaveEnoughMemory(input_->resolution(), input_->flags()) ) ){
-                temp_frame_ = new FrameBuffer( input_->resolution(), input_->flags() );
-            }
-            // image available
-            if (temp_frame_ != nullptr) {
-                // add element to queue (back)
-                frames_.push( temp_frame_ );
-                elapsed_.push( now_ );
-                // temp_frame_ FBO is now used, it should not be deleted
-                temp_frame_ = nullptr;
-            }
-            else {
+        // grow, or shrink if less than half is needed
+        if ( needed > capacity || needed < capacity / 2 ) {
+            if ( !allocate(needed) ) {
                 // set delay to maximum affordable
-                delay_ = now_ - elapsed_.front() - (dt * 0.001);
+                delay_ = double(capacity > 2 ? capacity - 2 : 0) / fps;
                 Log::Warning("Cannot satisfy delay: not enough RAM in graphics card.");
             }
         }
+
+        if ( recent_.capacity() < 1 )
+            return;
+
+        // make room for new frame: the oldest frame at full resolution
+        // is copied at lower resolution (if spill enabled) before reuse
+        if ( recent_.count == recent_.capacity() ) {
+            const size_t i = recent_.first;
+            if ( spill_.capacity() > 0 ) {
+                // drop oldest frame at lower resolution
+                if ( spill_.count == spill_.capacity() ) {
+                    spill_.first = spill_.index(1);
+                    --spill_.count;
+                }
+                const size_t j = spill_.index(spill_.count);
+                recent_.frames[i]->blit( spill_.frames[j] );
+                spill_.times[j] = recent_.times[i];
+                ++spill_.count;
+            }
+            recent_.first = recent_.index(1);
+            --recent_.count;
+        }
+
+        // new frame, to be filled in draw
+        const size_t k = recent_.index(recent_.count);
+        recent_.times[k] = now_;
+        ++recent_.count;
+        write_ = recent_.frames[k];
+
+        // output the most recent frame older than delay
+        select( now_ - delay_ );
+    }
+}
+
+void DelayFilter::select (double time)
+{
+    output_ = nullptr;
+
+    Ring *rings[2] = { &spill_, &recent_ };
+    for (Ring *r : rings) {
+        for (size_t i = 0; i < r->count; ++i) {
+            const size_t f = r->index(i);
+            if ( output_ != nullptr && r->times[f] > time )
+                return;
+            output_ = r->frames[f];
+            output_time_ = r->times[f];
+        }
     }
 }
 
 uint DelayFilter::texture () const
 {
-    if (!frames_.empty())
-        return frames_.front()->texture();
+    if (output_)
+        return output_->texture();
     else if (input_)
         return input_->texture();
     else
@@ -115,17 +229,23 @@ glm::vec3 DelayFilter::resolution () const
     return glm::vec3(1,1,0);
 }
 
+FrameBuffer *DelayFilter::frame () const
+{
+    if (output_)
+        return output_;
+
+    return input_;
+}
+
 void DelayFilter::draw (FrameBuffer *input)
 {
     input_ = input;
 
     if ( enabled() )
     {
-        // make sure the queue is not empty
-        if ( input_ && !frames_.empty() ) {
-            // blit input framebuffer in the newest image in queue (back)
-            input_->blit( frames_.back() );
-        }
+        // blit input framebuffer in the newest frame
+        if ( input_ && write_ )
+            input_->blit( write_ );
     }
 }
 
@@ -135,3 +255,38 @@ void DelayFilter::accept (Visitor& v)
     v.visit(*this);
 }
 
+TimeMachineFilter::TimeMachineFilter(): DelayFilter(), speed_(1.0), position_(0.0)
+{
+    delay_ = 5.0;
+}
+
+void TimeMachineFilter::setPosition (double second)
+{
+    position_ = CLAMP(second, 0.0, delay_);
+}
+
+void TimeMachineFilter::reset ()
+{
+    DelayFilter::reset();
+    position_ = 0.0;
+}
+
+void TimeMachineFilter::update (float dt)
+{
+    // keep history (delay_ is the duration of history)
+    DelayFilter::update(dt);
+
+    if ( write_ != nullptr ) {
+        // move playhead in history
+        position_ = CLAMP(position_ + (1.0 - speed_) * double(dt) * 0.001, 0.0, MIN(delay_, now_));
+
+        // output the frame at playhead
+        select( now_ - position_ );
+    }
+}
+
+void TimeMachineFilter::accept (Visitor& v)
+{
+    FrameBufferFilter::accept(v);
+    v.visit(*this);
+}
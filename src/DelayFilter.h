@@ -1,7 +1,7 @@
 #ifndef DELAYFILTER_H
 #define DELAYFILTER_H
 
-#include <queue>
+#include <vector>
 #include <glm/glm.hpp>
 
 #include "FrameBufferFilter.h"
@@ -9,6 +9,12 @@
 class Surface;
 class FrameBuffer;
 
+// duration of the most recent frames kept at full resolution when
+// older frames are downscaled (second)
+#define DELAY_FULL_RESOLUTION 1.0
+// reduction of resolution of older frames
+#define DELAY_SPILL_SCALE 2
+
 class DelayFilter : public FrameBufferFilter
 {
 public:
@@ -19,27 +25,90 @@ public:
     inline void setDelay(double second) { delay_ = second; }
     inline double delay() const { return delay_; }
 
+    // allow older frames at lower resolution if graphics memory is short
+    inline void setDownscale(bool on) { downscale_ = on; }
+    inline bool downscale() const { return downscale_; }
+
     // implementation of FrameBufferFilter
     Type type() const override { return FrameBufferFilter::FILTER_DELAY; }
     uint texture () const override;
     glm::vec3 resolution () const override;
+    FrameBuffer *frame () const override;
     void update (float dt) override;
     void reset () override;
     double updateTime () override;
     void draw   (FrameBuffer *input) override;
     void accept (Visitor& v) override;
 
-private:
-    // queue of frames
-    std::queue<FrameBuffer *> frames_;
-    std::queue<double> elapsed_;
+protected:
+    // circular buffer of frames, with their time
+    struct Ring {
+        std::vector<FrameBuffer *> frames;
+        std::vector<double> times;
+        size_t first;
+        size_t count;
+
+        Ring() : first(0), count(0) {}
+        inline size_t capacity () const { return frames.size(); }
+        inline size_t index (size_t i) const { return (first + i) % frames.size(); }
+        void resize (size_t capacity, glm::vec3 resolution, int flags);
+        void clear ();
+    };
+
+    // most recent frames at full resolution,
+    // older frames spilled at lower resolution (if downscale)
+    Ring recent_;
+    Ring spill_;
+    bool allocate (size_t frames);
+    bool allocate (size_t n_recent, size_t n_spill);
+    // output the most recent frame at time (oldest frame by default)
+    void select (double time);
 
     // render management
-    FrameBuffer *temp_frame_;
+    glm::vec3 resolution_;
+    int flags_;
+    FrameBuffer *write_;
+    FrameBuffer *output_;
+    double output_time_;
 
     // time management
     double now_;
     double delay_;
+    bool downscale_;
+};
+
+/**
+ * @brief The TimeMachineFilter keeps the history of its input (as the DelayFilter)
+ * and displays the frame at a playhead that moves in this history.
+ *
+ * The position of the playhead is the time (second) before the live input;
+ * it stays in place at speed 1, goes back in time for speed < 1 (freezes at 0,
+ * plays backward when negative) and comes back toward live for speed > 1.
+ */
+class TimeMachineFilter : public DelayFilter
+{
+public:
+    TimeMachineFilter();
+
+    // duration of history property
+    inline void setHistory(double second) { delay_ = second; }
+    inline double history() const { return delay_; }
+
+    // playhead properties
+    inline void setSpeed(double s) { speed_ = s; }
+    inline double speed() const { return speed_; }
+    void setPosition(double second);
+    inline double position() const { return position_; }
+
+    // implementation of FrameBufferFilter
+    Type type() const override { return FrameBufferFilter::FILTER_TIMEMACHINE; }
+    void update (float dt) override;
+    void reset () override;
+    void accept (Visitor& v) override;
+
+private:
+    double speed_;
+    double position_;
 };
 
 #endif // DELAYFILTER_H
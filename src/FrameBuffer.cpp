@@ -55,6 +55,24 @@ void FrameBuffer::init()
 {
     mem_usage_ = 0;
 
+    // take settings into account: no multisampling if application multisampling is level 0
+    if ( Settings::application.render.multisampling < 1 )
+        flags_ &= ~FrameBuffer_multisampling;
+
+    // reuse objects of a previous framebuffer if possible
+    FrameBufferPool::Objects objects;
+    if ( FrameBufferPool::manager().acquire(attrib_.viewport, flags_, objects) ) {
+        framebufferid_ = objects.framebuffer;
+        textureid_ = objects.texture;
+        multisampling_framebufferid_ = objects.multisampling_framebuffer;
+        multisampling_textureid_ = objects.multisampling_texture;
+        mem_usage_ = objects.mem_usage;
+#ifdef FRAMEBUFFER_DEBUG
+        g_printerr("Framebuffer %d reused (%d x %d)\n", framebufferid_, attrib_.viewport.x, attrib_.viewport.y);
+#endif
+        return;
+    }
+
     // generate texture
     glGenTextures(1, &textureid_);
     glBindTexture(GL_TEXTURE_2D, textureid_);
@@ -88,10 +106,6 @@ void FrameBuffer::init()
         g_printerr("Framebuffer %d created (%d x %d) - ", framebufferid_, attrib_.viewport.x, attrib_.viewport.y);
 #endif
 
-    // take settings into account: no multisampling if application multisampling is level 0
-    if ( Settings::application.render.multisampling < 1 )
-        flags_ &= ~FrameBuffer_multisampling;
-
     if (flags_ & FrameBuffer_multisampling){
 
         // create a multisample texture
@@ -143,6 +157,8 @@ void FrameBuffer::init()
     checkFramebufferStatus();
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    FrameBufferPool::manager().created(mem_usage_);
+
 #ifdef FRAMEBUFFER_DEBUG
     g_printerr("~%d kB allocated\n", mem_usage_);
 #endif
@@ -150,18 +166,29 @@ void FrameBuffer::init()
 
 FrameBuffer::~FrameBuffer()
 {
+    recycle();
+}
+
+void FrameBuffer::recycle()
+{
+    if (framebufferid_ == 0)
+        return;
+
 #ifdef FRAMEBUFFER_DEBUG
-    g_printerr("Framebuffer %d deleted - ~%d kB freed\n", framebufferid_, mem_usage_);
+    g_printerr("Framebuffer %d released - ~%d kB to pool\n", framebufferid_, mem_usage_);
 #endif
 
-    if (framebufferid_)
-        glDeleteFramebuffers(1, &framebufferid_);
-    if (multisampling_framebufferid_)
-        glDeleteFramebuffers(1, &multisampling_framebufferid_);
-    if (textureid_)
-        glDeleteTextures(1, &textureid_);
-    if (multisampling_textureid_)
-        glDeleteTextures(1, &multisampling_textureid_);
+    // give objects to the pool
+    FrameBufferPool::Objects objects = { framebufferid_, textureid_,
+                                         multisampling_framebufferid_, multisampling_textureid_,
+                                         mem_usage_ };
+    FrameBufferPool::manager().recycle(attrib_.viewport, flags_, objects);
+
+    framebufferid_ = 0;
+    textureid_ = 0;
+    multisampling_framebufferid_ = 0;
+    multisampling_textureid_ = 0;
+    mem_usage_ = 0;
 }
 
 uint FrameBuffer::texture() const
@@ -197,24 +224,10 @@ void FrameBuffer::resize(glm::vec3 res)
         if (attrib_.viewport.x != res.x || attrib_.viewport.y != res.y)
         {
             // de-init
-            glDeleteFramebuffers(1, &framebufferid_);
-            framebufferid_ = 0;
-
-            if (multisampling_framebufferid_)
-                glDeleteFramebuffers(1, &multisampling_framebufferid_);
-            multisampling_framebufferid_ = 0;
-
-            if (textureid_)
-                glDeleteTextures(1, &textureid_);
-            textureid_ = 0;
-
-            if (multisampling_textureid_)
-                glDeleteTextures(1, &multisampling_textureid_);
-            multisampling_textureid_ = 0;
+            recycle();
 
             // change resolution
             attrib_.viewport = glm::ivec2(res);
-            mem_usage_ = 0;
         }
     }
 }
@@ -301,9 +314,11 @@ bool FrameBuffer::blit(FrameBuffer *destination)
         glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferid_);
 
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination->framebufferid_);
-    // blit to the frame buffer object
+    // blit to the frame buffer object (interpolate if scaled)
+    const bool scaled = destination->width() != width() || destination->height() != height();
     glBlitFramebuffer(0, 0, attrib_.viewport.x, attrib_.viewport.y,
-                      0, 0, destination->width(), destination->height(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                      0, 0, destination->width(), destination->height(), GL_COLOR_BUFFER_BIT,
+                      scaled ? GL_LINEAR : GL_NEAREST);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     return true;
@@ -543,3 +558,92 @@ bool FrameBuffer::fill(FrameBufferImage *image)
 //    // delete (copy is also deleted)
 //    delete[] buffer;
 //}
+
+
+bool FrameBufferPool::acquire(glm::ivec2 size, int flags, Objects &objects)
+{
+    const int samples = (flags & FrameBuffer::FrameBuffer_multisampling) ? Settings::application.render.multisampling : 0;
+
+    for (auto e = pool_.begin(); e != pool_.end(); ++e) {
+        if ( e->size == size && e->flags == flags && e->samples == samples ) {
+            objects = e->objects;
+            pooled_ -= objects.mem_usage;
+            allocated_ += objects.mem_usage;
+            pool_.erase(e);
+            ++hits_;
+            return true;
+        }
+    }
+
+    ++misses_;
+    return false;
+}
+
+void FrameBufferPool::created(uint mem_usage)
+{
+    // make room in budget
+    trim(mem_usage);
+
+    allocated_ += mem_usage;
+}
+
+void FrameBufferPool::recycle(glm::ivec2 size, int flags, const Objects &objects)
+{
+    allocated_ -= MIN(allocated_, (size_t) objects.mem_usage);
+
+    Entry e;
+    e.size = size;
+    e.flags = flags;
+    e.samples = (flags & FrameBuffer::FrameBuffer_multisampling) ? Settings::application.render.multisampling : 0;
+    e.objects = objects;
+    pool_.push_front(e);
+    pooled_ += objects.mem_usage;
+
+    trim(0);
+}
+
+void FrameBufferPool::clear()
+{
+    while ( !pool_.empty() ) {
+        destroy(pool_.back().objects);
+        pool_.pop_back();
+    }
+    pooled_ = 0;
+}
+
+bool FrameBufferPool::canAllocate(uint mem_usage) const
+{
+    const size_t b = budget();
+    return ( b == 0 || allocated_ + mem_usage <= b );
+}
+
+size_t FrameBufferPool::budget() const
+{
+    // Settings in MB, budget in kB
+    return static_cast<size_t>( MAX(0, Settings::application.render.gpu_budget) ) * 1024;
+}
+
+void FrameBufferPool::trim(size_t needed)
+{
+    const size_t b = budget();
+
+    // delete oldest objects to fit in pool size and in budget
+    while ( !pool_.empty() && ( pooled_ > FRAMEBUFFER_POOL_MAX ||
+                                ( b > 0 && allocated_ + pooled_ + needed > b ) ) ) {
+        pooled_ -= MIN(pooled_, (size_t) pool_.back().objects.mem_usage);
+        destroy(pool_.back().objects);
+        pool_.pop_back();
+    }
+}
+
+void FrameBufferPool::destroy(const Objects &objects)
+{
+    if (objects.framebuffer)
+        glDeleteFramebuffers(1, &objects.framebuffer);
+    if (objects.multisampling_framebuffer)
+        glDeleteFramebuffers(1, &objects.multisampling_framebuffer);
+    if (objects.texture)
+        glDeleteTextures(1, &objects.texture);
+    if (objects.multisampling_texture)
+        glDeleteTextures(1, &objects.multisampling_texture);
+}
@@ -3,8 +3,11 @@
 
 #include "RenderingManager.h"
 
+#include <list>
+
 #define FBI_JPEG_QUALITY 90
 #define MIPMAP_LEVEL 7
+#define FRAMEBUFFER_POOL_MAX 262144 // kB
 
 /**
  * @brief The FrameBufferImage class stores an RGB image in RAM
@@ -105,6 +108,81 @@ private:
     uint textureid_, multisampling_textureid_;
     uint framebufferid_, multisampling_framebufferid_;
     uint mem_usage_;
+    void recycle();
+};
+
+/**
+ * @brief The FrameBufferPool keeps the OpenGL objects of FrameBuffers
+ * that are deleted or resized, and gives them to FrameBuffers created
+ * later with the same resolution and flags.
+ *
+ * Memory of all framebuffers (in use and in the pool) is accounted to
+ * respect the budget of graphics memory (Settings render.gpu_budget).
+ * Objects in the pool are deleted (oldest first) to stay within the
+ * budget and within FRAMEBUFFER_POOL_MAX kB.
+ */
+class FrameBufferPool
+{
+    // Private Constructor
+    FrameBufferPool() : allocated_(0), pooled_(0), hits_(0), misses_(0) {}
+    FrameBufferPool(FrameBufferPool const& copy) = delete;
+    FrameBufferPool& operator=(FrameBufferPool const& copy) = delete;
+
+public:
+
+    static FrameBufferPool& manager ()
+    {
+        // The only instance
+        static FrameBufferPool _instance;
+        return _instance;
+    }
+
+    struct Objects {
+        uint framebuffer;
+        uint texture;
+        uint multisampling_framebuffer;
+        uint multisampling_texture;
+        uint mem_usage;
+    };
+
+    // get objects of same resolution and flags, false if none in pool
+    bool acquire (glm::ivec2 size, int flags, Objects &objects);
+    // account for objects created (not found in pool)
+    void created (uint mem_usage);
+    // keep objects no longer used
+    void recycle (glm::ivec2 size, int flags, const Objects &objects);
+    // delete all objects in pool
+    void clear ();
+
+    // true if a framebuffer of that size (kB) fits in the budget
+    bool canAllocate (uint mem_usage) const;
+
+    // memory (kB) of framebuffers in use and in the pool
+    inline size_t allocated () const { return allocated_; }
+    inline size_t pooled () const { return pooled_; }
+    // statistics of reuse
+    inline uint64_t hits () const { return hits_; }
+    inline uint64_t misses () const { return misses_; }
+
+private:
+
+    struct Entry {
+        glm::ivec2 size;
+        int flags;
+        int samples;
+        Objects objects;
+    };
+    // most recently recycled first
+    std::list<Entry> pool_;
+
+    size_t allocated_;
+    size_t pooled_;
+    uint64_t hits_;
+    uint64_t misses_;
+
+    size_t budget () const;
+    void trim (size_t needed);
+    static void destroy (const Objects &objects);
 };
 
 
@@ -13,7 +13,8 @@ std::vector< std::tuple<int, int, std::string> > FrameBufferFilter::Types = {
     { ICON_FILTER_SMOOTH, std::string("Smooth & Noise") },
     { ICON_FILTER_EDGE, std::string("Edge") },
     { ICON_FILTER_ALPHA, std::string("Alpha") },
-    { ICON_FILTER_IMAGE, std::string("Custom shader") }
+    { ICON_FILTER_IMAGE, std::string("Custom shader") },
+    { ICON_FILTER_TIMEMACHINE, std::string("Time machine") }
 };
 
 FrameBufferFilter::FrameBufferFilter() : enabled_(true), input_(nullptr)
@@ -18,6 +18,7 @@ class FrameBuffer;
 #define ICON_FILTER_EDGE 16, 8
 #define ICON_FILTER_ALPHA 13, 4
 #define ICON_FILTER_IMAGE 1, 4
+#define ICON_FILTER_TIMEMACHINE 19, 15
 
 class FrameBufferFilter
 {
@@ -39,6 +40,7 @@ public:
         FILTER_EDGE,
         FILTER_ALPHA,
         FILTER_IMAGE,
+        FILTER_TIMEMACHINE,
         FILTER_INVALID
     } Type;
     static std::vector< std::tuple<int, int, std::string> > Types;
@@ -51,6 +53,9 @@ public:
     // get the resolution of the rendered filtered framebuffer
     virtual glm::vec3 resolution () const = 0;
 
+    // get the framebuffer holding the result, to chain filters
+    virtual FrameBuffer *frame () const { return input_; }
+
     // perform update (non rendering), given dt in milisecond
     virtual void update (float) {}
 
@@ -0,0 +1,179 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "Settings.h"
+
+#include "FrameCache.h"
+
+#define MEGABYTE 1048576
+
+FrameCache::FrameCache() : budget_(0), used_(0)
+{
+    setBudget( Settings::application.render.frame_cache );
+}
+
+void FrameCache::setBudget (uint megabytes)
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    budget_ = static_cast<size_t>(megabytes) * MEGABYTE;
+
+    // free least recently used frames to fit in budget
+    while ( used_ > budget_ && !lru_.empty() )
+        erase(lru_.back());
+}
+
+bool FrameCache::find (uint64_t player, GstClockTime position, PlayerFrames::iterator &it)
+{
+    // no frame of this player
+    auto p = frames_.find(player);
+    if ( p == frames_.end() )
+        return false;
+
+    // first frame after position
+    it = p->second.upper_bound(position);
+    if ( it == p->second.begin() )
+        return false;
+
+    // previous frame starts before position: does it cover it?
+    --it;
+    return position < it->first + it->second.duration;
+}
+
+void FrameCache::erase (FrameKey key)
+{
+    auto p = frames_.find(key.first);
+    if ( p == frames_.end() )
+        return;
+    auto it = p->second.find(key.second);
+    if ( it == p->second.end() )
+        return;
+
+    used_ -= gst_buffer_get_size(it->second.buffer);
+    gst_buffer_unref(it->second.buffer);
+    lru_.erase(it->second.lru);
+    p->second.erase(it);
+
+    // forget player without frames
+    if ( p->second.empty() )
+        frames_.erase(p);
+}
+
+void FrameCache::add (uint64_t player, GstBuffer *buf, const GstVideoInfo *info, GstClockTime duration,
+                      GstClockTime history)
+{
+    if ( buf == nullptr || info == nullptr || !GST_BUFFER_PTS_IS_VALID(buf) || duration == GST_CLOCK_TIME_NONE )
+        return;
+
+    // disabled or already have it
+    {
+        std::lock_guard<std::mutex> lock(access_);
+        if ( budget_ == 0 || cached(player, buf->pts) )
+            return;
+    }
+
+    // copy the frame outside of lock: do not hold buffers of the decoder pool
+    CachedFrame f;
+    f.buffer = gst_buffer_copy_deep(buf);
+    if ( f.buffer == nullptr )
+        return;
+    f.info = *info;
+    f.duration = duration;
+
+    std::lock_guard<std::mutex> lock(access_);
+
+    // added meanwhile, or disabled meanwhile
+    if ( budget_ == 0 || cached(player, buf->pts) ) {
+        gst_buffer_unref(f.buffer);
+        return;
+    }
+
+    f.lru = lru_.insert(lru_.begin(), FrameKey(player, buf->pts));
+    used_ += gst_buffer_get_size(f.buffer);
+    PlayerFrames &pf = frames_[player];
+    pf[buf->pts] = f;
+
+    // bounded history: free frames played before
+    if ( history != GST_CLOCK_TIME_NONE && buf->pts > history ) {
+        while ( !pf.empty() && pf.begin()->first < buf->pts - history )
+            erase( FrameKey(player, pf.begin()->first) );
+    }
+
+    // free least recently used frames to fit in budget
+    while ( used_ > budget_ && lru_.size() > 1 )
+        erase(lru_.back());
+}
+
+bool FrameCache::cached (uint64_t player, GstClockTime pts) const
+{
+    auto p = frames_.find(player);
+    return p != frames_.end() && p->second.count(pts) > 0;
+}
+
+bool FrameCache::enabled ()
+{
+    std::lock_guard<std::mutex> lock(access_);
+    return budget_ > 0;
+}
+
+bool FrameCache::contains (uint64_t player, GstClockTime position)
+{
+    if ( position == GST_CLOCK_TIME_NONE )
+        return false;
+
+    std::lock_guard<std::mutex> lock(access_);
+    if ( budget_ == 0 )
+        return false;
+
+    PlayerFrames::iterator it;
+    return find(player, position, it);
+}
+
+GstBuffer *FrameCache::get (uint64_t player, GstClockTime position, GstVideoInfo *info)
+{
+    if ( position == GST_CLOCK_TIME_NONE )
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(access_);
+    if ( budget_ == 0 )
+        return nullptr;
+
+    PlayerFrames::iterator it;
+    if ( !find(player, position, it) )
+        return nullptr;
+
+    // most recently used
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+
+    if ( info != nullptr )
+        *info = it->second.info;
+    return gst_buffer_ref(it->second.buffer);
+}
+
+void FrameCache::remove (uint64_t player)
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    // erase frames until the player is forgotten
+    auto p = frames_.find(player);
+    while ( p != frames_.end() ) {
+        erase( FrameKey(player, p->second.begin()->first) );
+        p = frames_.find(player);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <map>
+#include <list>
+#include <mutex>
+
+// GStreamer
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+/**
+ * @brief The FrameCache is a pool of decoded video frames in RAM,
+ * shared by all media players.
+ *
+ * Frames are indexed by player id and presentation time stamp, and
+ * the least recently used frames are discarded to stay within the
+ * memory budget. Each frame keeps its video info (the decoding size
+ * can change). Players read from the cache before seeking their
+ * pipeline (step, scrubbing, reverse play). During normal playback,
+ * a player keeps only a short history of frames before its position.
+ */
+class FrameCache
+{
+    // Private Constructor
+    FrameCache();
+    FrameCache(FrameCache const& copy) = delete;
+    FrameCache& operator=(FrameCache const& copy) = delete;
+
+public:
+
+    static FrameCache& manager ()
+    {
+        // The only instance
+        static FrameCache _instance;
+        return _instance;
+    }
+
+    // keep a copy of the buffer decoded by player, with its video info (streaming thread),
+    // and discard frames of player older than history before it (if given)
+    void add (uint64_t player, GstBuffer *buf, const GstVideoInfo *info, GstClockTime duration,
+              GstClockTime history = GST_CLOCK_TIME_NONE);
+    // true if a frame of the player covers the position
+    bool contains (uint64_t player, GstClockTime position);
+    // get the frame of player covering the position (to unref) and its video info, nullptr if not cached
+    GstBuffer *get (uint64_t player, GstClockTime position, GstVideoInfo *info);
+    // discard all frames of player
+    void remove (uint64_t player);
+
+    // memory budget, in MB (0 to disable)
+    void setBudget (uint megabytes);
+    bool enabled ();
+    inline size_t budget () const { return budget_; }
+    inline size_t used () const { return used_; }
+
+private:
+
+    typedef std::pair<uint64_t, GstClockTime> FrameKey;
+    struct CachedFrame {
+        GstBuffer *buffer;
+        GstVideoInfo info;
+        GstClockTime duration;
+        std::list<FrameKey>::iterator lru;
+    };
+    typedef std::map<GstClockTime, CachedFrame> PlayerFrames;
+
+    std::map<uint64_t, PlayerFrames> frames_;
+    std::list<FrameKey> lru_;
+    size_t budget_;
+    size_t used_;
+    std::mutex access_;
+
+    bool find (uint64_t player, GstClockTime position, PlayerFrames::iterator &it);
+    bool cached (uint64_t player, GstClockTime pts) const;
+    void erase (FrameKey key);
+};
+
+#endif // FRAMECACHE_H
@@ -0,0 +1,203 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "FrameQueue.h"
+
+FrameQueue::Frame::Frame()
+{
+    full = false;
+    status = INVALID;
+    position = GST_CLOCK_TIME_NONE;
+}
+
+void FrameQueue::Frame::unmap()
+{
+    if ( full )
+        gst_video_frame_unmap(&vframe);
+    full = false;
+}
+
+FrameQueue::FrameQueue(guint size) : frames_(MAX(size, 2)),
+    write_count_(0), read_count_(0), eos_pending_(false),
+    eos_position_(GST_CLOCK_TIME_NONE), eos_reading_(false),
+    preroll_pending_(false), preroll_writing_(false), preroll_reading_(false)
+{
+}
+
+FrameQueue::~FrameQueue()
+{
+    clear();
+}
+
+bool FrameQueue::publish_pending_eos(guint64 w, guint64 r)
+{
+    // no room or nothing to publish
+    if ( w - r >= frames_.size() || !eos_pending_.exchange(false) )
+        return false;
+
+    // write End-of-Stream in the ring, in order of arrival
+    Frame &f = frames_[w % frames_.size()];
+    f.status = EOS;
+    f.position = eos_position_.load();
+    write_count_.store(w + 1, std::memory_order_release);
+
+    return true;
+}
+
+FrameQueue::Frame *FrameQueue::writeFrame(FrameStatus status)
+{
+    guint64 w = write_count_.load(std::memory_order_relaxed);
+    const guint64 r = read_count_.load(std::memory_order_acquire);
+
+    // an End-of-Stream is waiting for room : publish it first
+    if ( eos_pending_.load(std::memory_order_acquire) && publish_pending_eos(w, r) )
+        ++w;
+
+    // queue is full : consumer still owns all frames
+    preroll_writing_ = false;
+    if ( w - r >= frames_.size() ) {
+        // never drop a pre-roll : use the spare frame if consumer released it
+        if ( status == PREROLL && !preroll_pending_.load(std::memory_order_acquire) ) {
+            preroll_writing_ = true;
+            return &preroll_frame_;
+        }
+        return nullptr;
+    }
+
+    // frame at writing index was released by consumer
+    return &frames_[w % frames_.size()];
+}
+
+void FrameQueue::push()
+{
+    // make spare pre-roll frame visible to consumer
+    if ( preroll_writing_ ) {
+        preroll_writing_ = false;
+        preroll_pending_.store(true, std::memory_order_release);
+        return;
+    }
+
+    const guint64 w = write_count_.load(std::memory_order_relaxed);
+    // make frame visible to consumer
+    write_count_.store(w + 1, std::memory_order_release);
+}
+
+void FrameQueue::pushEndOfStream(GstClockTime position)
+{
+    Frame *f = writeFrame();
+    if ( f ) {
+        f->status = EOS;
+        f->position = position;
+        push();
+    }
+    // keep it for later: never miss an End-of-Stream
+    else {
+        eos_position_.store(position);
+        eos_pending_.store(true, std::memory_order_release);
+    }
+}
+
+FrameQueue::Frame *FrameQueue::readFrame()
+{
+    guint64 r = read_count_.load(std::memory_order_relaxed);
+    const guint64 w = write_count_.load(std::memory_order_acquire);
+
+    // a pre-roll could not be pushed in the ring : older frames are obsolete
+    if ( preroll_pending_.load(std::memory_order_acquire) ) {
+        while ( r < w ) {
+            Frame &f = frames_[r % frames_.size()];
+            f.unmap();
+            f.status = INVALID;
+            read_count_.store(++r, std::memory_order_release);
+        }
+        preroll_reading_ = true;
+        return &preroll_frame_;
+    }
+
+    // nothing new in the ring
+    if ( r == w ) {
+        // End-of-Stream could not be pushed in the ring
+        if ( eos_pending_.load(std::memory_order_acquire) && eos_pending_.exchange(false) ) {
+            eos_frame_.status = EOS;
+            eos_frame_.position = eos_position_.load();
+            eos_reading_ = true;
+            return &eos_frame_;
+        }
+        return nullptr;
+    }
+
+    // skip older frames, but do NOT miss a pre-roll or an End-of-Stream
+    while ( w - r > 1 ) {
+        Frame &f = frames_[r % frames_.size()];
+        if ( f.status == PREROLL || f.status == EOS )
+            break;
+        f.unmap();
+        f.status = INVALID;
+        read_count_.store(++r, std::memory_order_release);
+    }
+
+    return &frames_[r % frames_.size()];
+}
+
+void FrameQueue::pop()
+{
+    // release pending End-of-Stream frame
+    if ( eos_reading_ ) {
+        eos_frame_.status = INVALID;
+        eos_reading_ = false;
+        return;
+    }
+
+    // release spare pre-roll frame
+    if ( preroll_reading_ ) {
+        preroll_frame_.unmap();
+        preroll_frame_.status = INVALID;
+        preroll_reading_ = false;
+        preroll_pending_.store(false, std::memory_order_release);
+        return;
+    }
+
+    const guint64 r = read_count_.load(std::memory_order_relaxed);
+    if ( r == write_count_.load(std::memory_order_acquire) )
+        return;
+
+    // free frame before giving it back to producer
+    Frame &f = frames_[r % frames_.size()];
+    f.unmap();
+    f.status = INVALID;
+    read_count_.store(r + 1, std::memory_order_release);
+}
+
+void FrameQueue::clear()
+{
+    for (auto f = frames_.begin(); f != frames_.end(); ++f) {
+        f->unmap();
+        f->status = INVALID;
+    }
+    eos_frame_.status = INVALID;
+    eos_reading_ = false;
+    eos_pending_ = false;
+    preroll_frame_.unmap();
+    preroll_frame_.status = INVALID;
+    preroll_writing_ = false;
+    preroll_reading_ = false;
+    preroll_pending_ = false;
+    write_count_ = 0;
+    read_count_ = 0;
+}
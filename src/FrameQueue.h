@@ -0,0 +1,85 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <atomic>
+#include <vector>
+
+// GStreamer
+#include <gst/video/video.h>
+
+/**
+ * @brief The FrameQueue class is a single-producer single-consumer
+ * ring of video frames, shared by MediaPlayer and Stream.
+ *
+ * The gstreamer streaming thread (producer) maps buffers into free
+ * frames and pushes them; the rendering thread (consumer) reads the
+ * most recent frame and pops it when done. Indices are atomic:
+ * neither side ever blocks on the other.
+ *
+ * When the consumer does not keep up, older frames are dropped on
+ * read, except PREROLL and EOS frames which are always delivered.
+ * When the ring is full, the producer drops the new frame (an EOS
+ * is kept pending until there is room). A PREROLL frame (e.g. after
+ * seek) is never dropped: it is written in a spare frame and older
+ * frames of the ring are discarded when it is read.
+ */
+class FrameQueue
+{
+public:
+
+    typedef enum  {
+        SAMPLE = 0,
+        PREROLL = 1,
+        EOS = 2,
+        INVALID = 3
+    } FrameStatus;
+
+    struct Frame {
+        GstVideoFrame vframe;
+        FrameStatus status;
+        bool full;
+        GstClockTime position;
+
+        Frame();
+        void unmap();
+    };
+
+    FrameQueue(guint size);
+    ~FrameQueue();
+
+    // producer : free frame to fill with a frame of given status (nullptr if queue is full)
+    Frame *writeFrame(FrameStatus status = SAMPLE);
+    // producer : publish frame obtained with writeFrame()
+    void push();
+    // producer : publish an End-of-Stream (never dropped)
+    void pushEndOfStream(GstClockTime position = GST_CLOCK_TIME_NONE);
+
+    // consumer : most recent frame to display (nullptr if none)
+    Frame *readFrame();
+    // consumer : release frame obtained with readFrame()
+    void pop();
+
+    // empty the queue; producer must be stopped
+    void clear();
+
+private:
+    std::vector<Frame> frames_;
+    std::atomic<guint64> write_count_;
+    std::atomic<guint64> read_count_;
+
+    // End-of-Stream received while queue was full
+    std::atomic<bool> eos_pending_;
+    std::atomic<GstClockTime> eos_position_;
+    Frame eos_frame_;
+    bool eos_reading_;
+
+    // Pre-roll received while queue was full
+    std::atomic<bool> preroll_pending_;
+    Frame preroll_frame_;
+    bool preroll_writing_;
+    bool preroll_reading_;
+
+    bool publish_pending_eos(guint64 w, guint64 r);
+};
+
+#endif // FRAMEQUEUE_H
@@ -40,6 +40,7 @@
 #include "ImageShader.h"
 #include "ImageProcessingShader.h"
 #include "MediaPlayer.h"
+#include "MediaProxy.h"
 #include "MediaSource.h"
 #include "CloneSource.h"
 #include "FrameBufferFilter.h"
@@ -693,7 +694,24 @@ void ImGuiVisitor::visit (MediaSource& s)
         ImGui::SetCursorPos(top);
         if (ImGuiToolkit::IconButton(ICON_FA_FOLDER_OPEN, "Show in finder"))
             SystemToolkit::open(SystemToolkit::path_filename(s.path()));
+        top.x += ImGui::GetFrameHeight();
 
+        // icon to create intra-frame proxy of video
+        if ( !s.mediaplayer()->isImage() ) {
+            ImGui::SetCursorPos(top);
+            if ( MediaProxy::manager().busy(s.path()) ) {
+                char msg[64];
+                snprintf(msg, 64, "Creating proxy %.0f%%", MediaProxy::manager().progress(s.path()) * 100.f);
+                ImGuiToolkit::IconButton(ICON_FA_HOURGLASS_HALF, msg);
+            }
+            else if ( !MediaProxy::manager().find(s.path()).empty() ) {
+                ImGuiToolkit::IconButton(ICON_FA_FILE_VIDEO, Settings::application.source.proxy ?
+                                         "Proxy available\n(used when media is loaded)" :
+                                         "Proxy available\n(disabled in settings)");
+            }
+            else if (ImGuiToolkit::IconButton(ICON_FA_COMPRESS_ARROWS_ALT, "Create proxy\n(fast seek and scrubbing)"))
+                MediaProxy::manager().generate(s.path());
+        }
     }
     else {
         ImGui::SetCursorPos(top);
@@ -916,6 +934,59 @@ void ImGuiVisitor::visit (DelayFilter& f)
         f.setDelay(0.5f);
         Action::manager().store("Delay 0.5 s");
     }
+
+    // lower resolution for frames older than 1 s if graphics memory is short
+    bool b = f.downscale();
+    if (ImGuiToolkit::ButtonSwitch("Downscale if needed", &b)) {
+        f.setDownscale(b);
+        Action::manager().store(b ? "Delay downscale on" : "Delay downscale off");
+    }
+}
+
+void ImGuiVisitor::visit (TimeMachineFilter& f)
+{
+    std::ostringstream oss;
+
+    // duration of history
+    ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+    float h = f.history();
+    if (ImGui::SliderFloat("##History", &h, 0.f, 10.f, "%.1f s"))
+        f.setHistory(h);
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        oss << "Time machine " << std::setprecision(3) << h << " s";
+        Action::manager().store(oss.str());
+    }
+    ImGui::SameLine(0, IMGUI_SAME_LINE);
+    if (ImGuiToolkit::TextButton("History ")) {
+        f.setHistory(5.f);
+        Action::manager().store("Time machine 5 s");
+    }
+
+    // speed of playhead (1 to follow live, 0 to freeze, negative to reverse)
+    ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+    float s = f.speed();
+    if (ImGui::SliderFloat("##Speed", &s, -2.f, 2.f, "x %.2f"))
+        f.setSpeed(s);
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        oss.str("");
+        oss << "Time machine speed " << std::setprecision(3) << s;
+        Action::manager().store(oss.str());
+    }
+    ImGui::SameLine(0, IMGUI_SAME_LINE);
+    if (ImGuiToolkit::TextButton("Speed ")) {
+        f.setSpeed(1.f);
+        Action::manager().store("Time machine speed 1");
+    }
+
+    // position of playhead (scratch)
+    ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+    float p = f.position();
+    if (ImGui::SliderFloat("##Position", &p, f.history(), 0.f, "-%.2f s"))
+        f.setPosition(p);
+    ImGui::SameLine(0, IMGUI_SAME_LINE);
+    if (ImGuiToolkit::TextButton("Playhead ")) {
+        f.setPosition(0.f);
+    }
 }
 
 void ImGuiVisitor::visit (ResampleFilter& f)
@@ -1265,6 +1336,50 @@ void ImGuiVisitor::visit (CloneSource& s)
         // filter options
         s.filter()->accept(*this);
 
+        // filters chained after the first (not filters of time)
+        std::vector< std::tuple<int, int, std::string> > chainable( FrameBufferFilter::Types.begin() + FrameBufferFilter::FILTER_RESAMPLE,
+                                                                     FrameBufferFilter::Types.begin() + FrameBufferFilter::FILTER_TIMEMACHINE );
+        for (size_t i = 1; i < s.numFilters(); ++i) {
+            ImGui::PushID( (int) i );
+            int t = (int) s.filter(i)->type() - FrameBufferFilter::FILTER_RESAMPLE;
+            ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+            if (ImGuiToolkit::ComboIcon("##ChainFilter", &t, chainable)) {
+                t += FrameBufferFilter::FILTER_RESAMPLE;
+                s.setFilter( FrameBufferFilter::Type(t), i );
+                oss << ": Filter " << i + 1 << " " << std::get<2>(FrameBufferFilter::Types[t]);
+                Action::manager().store(oss.str());
+                info.reset();
+            }
+            ImGui::SameLine(0, IMGUI_SAME_LINE);
+            if (ImGuiToolkit::TextButton("Then", "Remove filter")) {
+                s.removeFilter(i);
+                oss << ": Remove filter " << i + 1;
+                Action::manager().store(oss.str());
+                info.reset();
+                ImGui::PopID();
+                break;
+            }
+            s.filter(i)->accept(*this);
+            ImGui::PopID();
+        }
+
+        // add a filter at the end of the chain
+        if ( s.numFilters() > 1 || s.filter()->type() != FrameBufferFilter::FILTER_PASSTHROUGH ) {
+            ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+            if (ImGui::BeginCombo("##AddFilter", ICON_FA_PLUS_CIRCLE " Add filter", ImGuiComboFlags_None)) {
+                for (int t = 0; t < (int) chainable.size(); ++t) {
+                    if (ImGuiToolkit::SelectableIcon( std::get<2>(chainable[t]).c_str(),
+                                                      std::get<0>(chainable[t]), std::get<1>(chainable[t]) )) {
+                        s.addFilter( FrameBufferFilter::Type(t + FrameBufferFilter::FILTER_RESAMPLE) );
+                        oss << ": Add filter " << std::get<2>(chainable[t]);
+                        Action::manager().store(oss.str());
+                        info.reset();
+                    }
+                }
+                ImGui::EndCombo();
+            }
+        }
+
         ImVec2 botom = ImGui::GetCursorPos();
 
         // icon (>) to open player
@@ -18,11 +18,19 @@
 **/
 #include <ctime>
 #include <algorithm>
+#include <sstream>
+#include <regex>
+#include <set>
+#include <cmath>
+#include <cstdio>
+
+#include <glad/glad.h>
 
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "defines.h"
+#include "Settings.h"
 #include "Resource.h"
 #include "Visitor.h"
 #include "FrameBuffer.h"
@@ -58,6 +66,65 @@ std::string fragmentFooter = "void main() {\n"
                              "    mainImage( FragColor, texcoord.xy * iResolution.xy );\n"
                              "}\n";
 
+// Compute shader running the same filter code: each work group of TILE x TILE pixels
+// first loads the texels of iChannel0 it covers (with an apron of APRON texels around,
+// enough for the largest kernels) in shared memory, and the filter code reads them
+// with tileTexture() instead of texture(). Reads outside of the tile use the texture.
+#define COMPUTE_TILE 16  // same as TILE in GLSL
+std::string computeHeader  = "#version 430 core\n"
+                             "#define TILE 16\n"
+                             "#define APRON 11\n"
+                             "#define TILE_SIZE (TILE + 2 * APRON)\n"
+                             "layout(local_size_x = TILE, local_size_y = TILE) in;\n"
+                             "layout(rgba8, binding = 0) uniform writeonly image2D iOutput;\n"
+                             "vec3 iChannelResolution[2];\n"
+                             "uniform mat4      iTransform;\n"
+                             "uniform vec3      iResolution;\n"
+                             "uniform sampler2D iChannel0;\n"
+                             "uniform sampler2D iChannel1;\n"
+                             "uniform float     iTime;\n"
+                             "uniform float     iTimeDelta;\n"
+                             "uniform int       iFrame;\n"
+                             "uniform vec4      iDate;\n"
+                             "uniform vec4      iMouse;\n"
+                             "shared vec4 tile[TILE_SIZE * TILE_SIZE];\n"
+                             "ivec2 tileOrigin;\n"
+                             "vec4 tileTexel(ivec2 p) {\n"
+                             "    return tile[p.y * TILE_SIZE + p.x];\n"
+                             "}\n"
+                             "vec4 tileTexture(vec2 uv) {\n"
+                             "    vec2 p = uv * iChannelResolution[0].xy - 0.5 - vec2(tileOrigin);\n"
+                             "    ivec2 i = ivec2(floor(p));\n"
+                             "    if ( any(lessThan(i, ivec2(0))) || any(greaterThan(i, ivec2(TILE_SIZE - 2))) )\n"
+                             "        return textureLod(iChannel0, uv, 0.0);\n"
+                             "    vec2 f = floor( (p - vec2(i)) * 256.0 + 0.5) / 256.0;\n"
+                             "    return mix( mix(tileTexel(i), tileTexel(i + ivec2(1, 0)), f.x),\n"
+                             "                mix(tileTexel(i + ivec2(0, 1)), tileTexel(i + ivec2(1, 1)), f.x), f.y);\n"
+                             "}\n";
+
+std::string computeFooter  = "int mirrored(int p, int n) {\n"
+                             "    p = p < 0 ? -p - 1 : p;\n"
+                             "    p = p < n ? p : 2 * n - 1 - p;\n"
+                             "    return clamp(p, 0, n - 1);\n"
+                             "}\n"
+                             "void main() {\n"
+                             "    iChannelResolution[0] = vec3(textureSize(iChannel0, 0), 0.f);\n"
+                             "    iChannelResolution[1] = vec3(textureSize(iChannel1, 0), 0.f);\n"
+                             "    ivec2 size = ivec2(iChannelResolution[0].xy);\n"
+                             "    tileOrigin = ivec2( vec2(gl_WorkGroupID.xy) * float(TILE) * iChannelResolution[0].xy / iResolution.xy ) - APRON;\n"
+                             "    for (int t = int(gl_LocalInvocationIndex); t < TILE_SIZE * TILE_SIZE; t += TILE * TILE) {\n"
+                             "        ivec2 p = tileOrigin + ivec2(t % TILE_SIZE, t / TILE_SIZE);\n"
+                             "        tile[t] = texelFetch(iChannel0, ivec2(mirrored(p.x, size.x), mirrored(p.y, size.y)), 0);\n"
+                             "    }\n"
+                             "    barrier();\n"
+                             "    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);\n"
+                             "    if ( any(greaterThanEqual(pixel, ivec2(iResolution.xy))) )\n"
+                             "        return;\n"
+                             "    vec4 color;\n"
+                             "    mainImage( color, vec2(pixel) + 0.5 );\n"
+                             "    imageStore( iOutput, pixel, color );\n"
+                             "}\n";
+
 std::list< FilteringProgram > FilteringProgram::presets = {
     FilteringProgram(),
     FilteringProgram("Bilateral","shaders/filters/focus.glsl",      "",     { }),
@@ -99,20 +166,22 @@ glm::vec4 FilteringProgram::iMouse = glm::vec4(0.5f,0.5f,0.f,0.f);
 ///                                 ////
 ////////////////////////////////////////
 
-FilteringProgram::FilteringProgram() : name_("Default"), code_({"shaders/filters/default.glsl",""}), two_pass_filter_(false)
+FilteringProgram::FilteringProgram() : name_("Default"), code_({"shaders/filters/default.glsl",""}), two_pass_filter_(false), pointwise_(false)
 {
 
 }
 
 FilteringProgram::FilteringProgram(const std::string &name, const std::string &first_pass, const std::string &second_pass,
-                         const std::map<std::string, float> &parameters) :
+                         const std::map<std::string, float> &parameters, bool pointwise) :
     name_(name), code_({first_pass, second_pass}), parameters_(parameters)
 {
     two_pass_filter_ = !second_pass.empty();
+    pointwise_ = pointwise && !two_pass_filter_;
 }
 
 FilteringProgram::FilteringProgram(const FilteringProgram &other) :
-    name_(other.name_), code_(other.code_), parameters_(other.parameters_), two_pass_filter_(other.two_pass_filter_)
+    name_(other.name_), code_(other.code_), parameters_(other.parameters_), two_pass_filter_(other.two_pass_filter_),
+    pointwise_(other.pointwise_)
 {
 
 }
@@ -125,6 +194,7 @@ FilteringProgram& FilteringProgram::operator= (const FilteringProgram& other)
         this->parameters_.clear();
         this->parameters_ = other.parameters_;
         this->two_pass_filter_ = other.two_pass_filter_;
+        this->pointwise_ = other.pointwise_;
     }
 
     return *this;
@@ -151,6 +221,98 @@ bool FilteringProgram::operator!= (const FilteringProgram& other) const
     return false;
 }
 
+////////////////////////////////////////
+/////                                 //
+////  FUSION OF POINTWISE PROGRAMS   ///
+///                                 ////
+////////////////////////////////////////
+
+// declaration of uniform, constant, variable or function at global scope
+const std::regex glslDeclaration("^\\s*(?:uniform\\s+|const\\s+)?(?:void|bool|int|uint|float|[biu]?vec[234]|mat[234])\\s+([A-Za-z_]\\w*)");
+// definition of a macro
+const std::regex glslMacro("^\\s*#\\s*define\\s+([A-Za-z_]\\w*)");
+// reading of the input texture
+const std::regex glslInput("texture\\s*\\(\\s*iChannel0\\s*,");
+
+std::string fusedCode(const std::string &code, size_t stage)
+{
+    const std::string suffix = "_" + std::to_string(stage);
+    std::set<std::string> names;
+    std::list<std::string> macros;
+
+    // find names declared at global scope (outside of braces)
+    std::istringstream lines(code);
+    std::string line;
+    long depth = 0;
+    while (std::getline(lines, line)) {
+        std::smatch m;
+        if ( depth == 0 && std::regex_search(line, m, glslDeclaration) )
+            names.insert(m[1].str());
+        else if ( std::regex_search(line, m, glslMacro) )
+            macros.push_back(m[1].str());
+        depth += std::count(line.begin(), line.end(), '{') - std::count(line.begin(), line.end(), '}');
+    }
+
+    // rename global names to avoid conflicts between stages (but not fields after '.')
+    std::string result = code;
+    for (auto n = names.begin(); n != names.end(); ++n)
+        result = std::regex_replace(result, std::regex("(^|[^.\\w])" + *n + "\\b"), "$1" + *n + suffix);
+
+    // after the first stage, input is the result of the previous stage
+    if (stage > 0)
+        result = std::regex_replace(result, glslInput, "fusedInput_" + std::to_string(stage - 1) + "(");
+
+    // macros of this stage do not apply to next stages
+    result += "\n";
+    for (auto m = macros.begin(); m != macros.end(); ++m)
+        result += "#undef " + *m + "\n";
+
+    // function giving the result of this stage, to be read by next stage
+    result += "vec4 fusedInput" + suffix + "(vec2 uv)\n{\n"
+              "    vec4 c;\n"
+              "    mainImage" + suffix + "(c, uv * iResolution.xy);\n"
+              "    return c;\n}\n";
+
+    return result;
+}
+
+FilteringProgram FilteringProgram::fuse(const std::vector<FilteringProgram> &programs)
+{
+    std::string name;
+    std::string code;
+
+    for (size_t i = 0; i < programs.size(); ++i) {
+        FilteringProgram p = programs[i];
+        name += (i > 0 ? " + " : "") + p.name();
+        code += fusedCode(p.code().first, i);
+    }
+
+    // main function of the fused program gives the result of the last stage
+    code += "void mainImage( out vec4 fragColor, in vec2 fragCoord )\n{\n"
+            "    mainImage_" + std::to_string(programs.size() - 1) + "(fragColor, fragCoord);\n}\n";
+
+    return FilteringProgram(name, code, "", fuseParameters(programs), true);
+}
+
+std::map< std::string, float > FilteringProgram::fuseParameters(const std::vector<FilteringProgram> &programs)
+{
+    // names of uniforms are renamed in each stage
+    std::map< std::string, float > parameters;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        for (auto p = programs[i].parameters_.begin(); p != programs[i].parameters_.end(); ++p)
+            parameters[p->first + "_" + std::to_string(i)] = p->second;
+    }
+
+    return parameters;
+}
+
+
+std::string computeCode(const std::string &code)
+{
+    // input is read from the tile in shared memory
+    return computeHeader + std::regex_replace(code, glslInput, "tileTexture(") + computeFooter;
+}
+
 
 ////////////////////////////////////////
 /////                                 //
@@ -166,6 +328,9 @@ ImageFilteringShader::ImageFilteringShader(): ImageShader()
     shader_code_ = fragmentHeader + filterDefault + fragmentFooter;
     custom_shading_.setShaders("shaders/image.vs", shader_code_);
 
+    compute_code_ = computeCode(filterDefault);
+    compute_shading_.setComputeShader(compute_code_);
+
     timer_ = g_timer_new ();
     iTime_ = 0.0;
     iFrame_ = 0;
@@ -176,6 +341,7 @@ ImageFilteringShader::ImageFilteringShader(): ImageShader()
 ImageFilteringShader::~ImageFilteringShader()
 {
     custom_shading_.reset();
+    compute_shading_.reset();
     g_timer_destroy(timer_);
 }
 
@@ -247,6 +413,9 @@ void ImageFilteringShader::setCode(const std::string &code, std::promise<std::st
         std::string::difference_type n = std::count(fragmentHeader.begin(), fragmentHeader.end(), '\n');
         // launch build
         custom_shading_.setShaders("shaders/image.vs", shader_code_, (int)n, ret);
+        // compute shader is built only if dispatched
+        compute_code_ = computeCode(code_);
+        compute_shading_.setComputeShader(compute_code_);
     }
     else if (ret != nullptr) {
         ret->set_value("No change.");
@@ -260,6 +429,50 @@ void ImageFilteringShader::copy(ImageFilteringShader const& S)
     // change the shading code for fragment
     shader_code_ = S.shader_code_;
     custom_shading_.setShaders("shaders/image.vs", shader_code_);
+
+    // and for compute
+    compute_code_ = S.compute_code_;
+    compute_shading_.setComputeShader(compute_code_);
+}
+
+bool ImageFilteringShader::dispatch(uint input, FrameBuffer *output)
+{
+    // image of compute shader is RGBA, and written directly in texture
+    if ( !ShadingProgram::computeSupported() || output == nullptr ||
+         !(output->flags() & FrameBuffer::FrameBuffer_alpha) ||
+          (output->flags() & FrameBuffer::FrameBuffer_multisampling) )
+        return false;
+
+    // bind output framebuffer to set the viewport (iResolution)
+    output->begin(false);
+
+    // set uniforms of the compute program
+    program_ = &compute_shading_;
+    use();
+    program_ = &custom_shading_;
+
+    // failed to compile: use fragment shader instead
+    if ( !compute_shading_.linked() ) {
+        output->end();
+        return false;
+    }
+
+    // input texture, with same wrapping as Surface
+    glBindTexture(GL_TEXTURE_2D, input);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+
+    // output image, one invocation per pixel
+    glBindImageTexture(0, output->texture(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glm::ivec2 size = glm::ivec2( output->resolution() );
+    glDispatchCompute( (size.x + COMPUTE_TILE - 1) / COMPUTE_TILE, (size.y + COMPUTE_TILE - 1) / COMPUTE_TILE, 1);
+
+    // make image available for texture reading and blit
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+    output->end();
+    return true;
 }
 
 
@@ -269,7 +482,7 @@ void ImageFilteringShader::copy(ImageFilteringShader const& S)
 ///                                 ////
 ////////////////////////////////////////
 
-ImageFilter::ImageFilter (): FrameBufferFilter(), buffers_({nullptr, nullptr})
+ImageFilter::ImageFilter (): FrameBufferFilter(), compute_(false), computing_(false), buffers_({nullptr, nullptr})
 {
     // surface and shader for first pass
     shaders_.first  = new ImageFilteringShader;
@@ -313,6 +526,14 @@ void ImageFilter::update (float dt)
         shaders_.second->update(dt);
 }
 
+FrameBuffer *ImageFilter::frame () const
+{
+    if (buffers_.first && buffers_.second)
+        return program_.isTwoPass() ? buffers_.second : buffers_.first;
+
+    return input_;
+}
+
 uint ImageFilter::texture () const
 {
     if (buffers_.first && buffers_.second)
@@ -335,14 +556,27 @@ glm::vec3 ImageFilter::resolution () const
     return glm::vec3(1,1,0);
 }
 
+bool ImageFilter::computing () const
+{
+    // pointwise programs do not read neighbor pixels; nothing to gain
+    return compute_ && !program_.isPointwise() && Settings::application.render.compute_filters
+            && ShadingProgram::computeSupported();
+}
+
 void ImageFilter::draw (FrameBuffer *input)
 {
     bool forced = false;
+    bool compute = computing();
 
-    // if input changed (typically on first draw)
-    if (input_ != input) {
+    // if input changed (typically on first draw) or if switching to/from compute shader
+    if (input_ != input || computing_ != compute) {
         // keep reference to input framebuffer
         input_ = input;
+        computing_ = compute;
+        // compute shaders write images in RGBA and without multisampling
+        FrameBuffer::FrameBufferFlags flags = input_->flags();
+        if (computing_)
+            flags = (flags | FrameBuffer::FrameBuffer_alpha) & ~FrameBuffer::FrameBuffer_multisampling;
         // create first-pass surface and shader, taking as texture the input framebuffer
         surfaces_.first->setTextureIndex( input_->texture() );
         shaders_.first->mask_texture = input_->texture();
@@ -350,7 +584,7 @@ void ImageFilter::draw (FrameBuffer *input)
         if (buffers_.first != nullptr)
             delete buffers_.first;
         // FBO
-        buffers_.first = new FrameBuffer( input_->resolution(), input_->flags() );
+        buffers_.first = new FrameBuffer( input_->resolution(), flags );
         // enforce framebuffer if first-pass is created now, filled with input framebuffer
         input_->blit( buffers_.first );
         // create second-pass surface and shader, taking as texture the first-pass framebuffer
@@ -367,17 +601,23 @@ void ImageFilter::draw (FrameBuffer *input)
     if ( enabled() || forced )
     {
         // FIRST PASS
-        // render input surface into frame buffer
-        buffers_.first->begin();
-        surfaces_.first->draw(glm::identity<glm::mat4>(), buffers_.first->projection());
-        buffers_.first->end();
+        // compute input texture into frame buffer (if possible)
+        if ( !computing_ || !shaders_.first->dispatch( input_->texture(), buffers_.first ) ) {
+            // render input surface into frame buffer
+            buffers_.first->begin();
+            surfaces_.first->draw(glm::identity<glm::mat4>(), buffers_.first->projection());
+            buffers_.first->end();
+        }
 
         // SECOND PASS
         if ( program_.isTwoPass() ) {
-            // render filtered surface from first pass into frame buffer
-            buffers_.second->begin();
-            surfaces_.second->draw(glm::identity<glm::mat4>(), buffers_.second->projection());
-            buffers_.second->end();
+            // compute filtered texture from first pass into frame buffer (if possible)
+            if ( !computing_ || !shaders_.second->dispatch( buffers_.first->texture(), buffers_.second ) ) {
+                // render filtered surface from first pass into frame buffer
+                buffers_.second->begin();
+                surfaces_.second->draw(glm::identity<glm::mat4>(), buffers_.second->projection());
+                buffers_.second->end();
+            }
         }
     }
 }
@@ -389,7 +629,7 @@ void ImageFilter::accept (Visitor& v)
 }
 
 
-FilteringProgram ImageFilter::program () const
+const FilteringProgram &ImageFilter::program () const
 {
     return program_;
 }
@@ -561,7 +801,13 @@ std::vector< FilteringProgram > BlurFilter::programs_ = {
     FilteringProgram("Fast",     "shaders/filters/blur.glsl", "", { })
 };
 
-BlurFilter::BlurFilter (): ImageFilter(), method_(BLUR_INVALID), mipmap_buffer_(nullptr)
+const char* BlurFilter::quality_label[BlurFilter::BLUR_QUALITY_INVALID] = {
+    "Low", "Medium", "High"
+};
+
+const int BlurFilter::quality_taps[BlurFilter::BLUR_QUALITY_INVALID] = { 7, 13, 25 };
+
+BlurFilter::BlurFilter (): ImageFilter(), method_(BLUR_INVALID), mipmap_buffer_(nullptr), downsampled_buffer_(nullptr)
 {
     mipmap_surface_ = new Surface;
 }
@@ -571,6 +817,8 @@ BlurFilter::~BlurFilter ()
     delete mipmap_surface_;
     if ( mipmap_buffer_!= nullptr )
         delete mipmap_buffer_;
+    if ( downsampled_buffer_!= nullptr )
+        delete downsampled_buffer_;
 }
 
 void BlurFilter::setMethod(int method)
@@ -622,6 +870,10 @@ void BlurFilter::draw (FrameBuffer *input)
         if (buffers_.second != nullptr)
             delete buffers_.second;
         buffers_.second = new FrameBuffer( input_->resolution(), f );
+        // framebuffer for second-pass at lower level created when needed
+        if (downsampled_buffer_ != nullptr)
+            delete downsampled_buffer_;
+        downsampled_buffer_ = nullptr;
         // forced draw
         forced = true;
     }
@@ -634,18 +886,56 @@ void BlurFilter::draw (FrameBuffer *input)
         mipmap_surface_->draw(glm::identity<glm::mat4>(), mipmap_buffer_->projection());
         mipmap_buffer_->end();
 
+        // GAUSSIAN is computed in separable passes on the level of details where
+        // taps are 1 to 2 pixels apart: the larger the radius, the lower the level
+        // (the number of taps set by quality, the cost is the same for any radius)
+        int level = 0;
+        glm::vec3 res = input_->resolution();
+        if ( method_ == BLUR_GAUSSIAN ) {
+            const int taps = quality_taps[ CLAMP(Settings::application.render.blur_quality,
+                                                 BLUR_QUALITY_LOW, BLUR_QUALITY_HIGH) ];
+            float radius = 0.f;
+            const std::map< std::string, float > parameters = program().parameters();
+            if ( parameters.count("Radius") > 0 )
+                radius = 0.5f * parameters.at("Radius") * res.y;
+            const float spacing = 2.f * radius / float(taps - 1);
+            if ( spacing > 1.f )
+                level = MIN( (int) std::floor( std::log2(spacing) ), MIPMAP_LEVEL );
+            res = glm::max( glm::vec3(1.f, 1.f, 0.f), glm::floor( res / float(1 << level) ) );
+
+            shaders_.first->uniforms_["Taps"] = float(taps);
+            shaders_.first->uniforms_["Level"] = float(level);
+            shaders_.second->uniforms_["Taps"] = float(taps);
+        }
+
         // FIRST PASS
-        // render mipmapped texture into frame buffer
+        // render mipmapped texture into frame buffer (at resolution of level)
+        if ( buffers_.first->resolution() != res )
+            buffers_.first->resize( res );
         buffers_.first->begin();
         surfaces_.first->draw(glm::identity<glm::mat4>(), buffers_.first->projection());
         buffers_.first->end();
+        surfaces_.second->setTextureIndex( buffers_.first->texture() );
 
         // SECOND PASS
         if ( program().isTwoPass() ) {
             // render filtered surface from first pass into frame buffer
-            buffers_.second->begin();
-            surfaces_.second->draw(glm::identity<glm::mat4>(), buffers_.second->projection());
-            buffers_.second->end();
+            // (downsampled frame buffer if at lower level)
+            FrameBuffer *target = buffers_.second;
+            if ( level > 0 ) {
+                if ( downsampled_buffer_ == nullptr )
+                    downsampled_buffer_ = new FrameBuffer( res, buffers_.second->flags() );
+                else if ( downsampled_buffer_->resolution() != res )
+                    downsampled_buffer_->resize( res );
+                target = downsampled_buffer_;
+            }
+            target->begin();
+            surfaces_.second->draw(glm::identity<glm::mat4>(), target->projection());
+            target->end();
+
+            // upsample into frame buffer at input resolution
+            if ( target != buffers_.second )
+                target->blit( buffers_.second );
         }
     }
 }
@@ -677,6 +967,7 @@ std::vector< FilteringProgram > SharpenFilter::programs_ = {
 
 SharpenFilter::SharpenFilter (): ImageFilter(), method_(SHARPEN_INVALID)
 {
+    compute_ = true;
 }
 
 void SharpenFilter::setMethod(int method)
@@ -720,12 +1011,13 @@ std::vector< FilteringProgram > SmoothFilter::programs_ = {
     FilteringProgram("Erosion",  "shaders/filters/erosion.glsl",    "",     { { "Radius", 0.5} }),
     FilteringProgram("Dilation", "shaders/filters/dilation.glsl",   "",     { { "Radius", 0.5} }),
     FilteringProgram("Denoise",  "shaders/filters/denoise.glsl",    "",     { { "Threshold", 0.5} }),
-    FilteringProgram("Noise",    "shaders/filters/noise.glsl",      "",     { { "Amount", 0.25} }),
-    FilteringProgram("Grain",    "shaders/filters/grain.glsl",      "",     { { "Amount", 0.5} })
+    FilteringProgram("Noise",    "shaders/filters/noise.glsl",      "",     { { "Amount", 0.25} }, true),
+    FilteringProgram("Grain",    "shaders/filters/grain.glsl",      "",     { { "Amount", 0.5} }, true)
 };
 
 SmoothFilter::SmoothFilter (): ImageFilter(), method_(SMOOTH_INVALID)
 {
+    compute_ = true;
 }
 
 void SmoothFilter::setMethod(int method)
@@ -769,6 +1061,7 @@ std::vector< FilteringProgram > EdgeFilter::programs_ = {
 
 EdgeFilter::EdgeFilter (): ImageFilter(), method_(EDGE_INVALID)
 {
+    compute_ = true;
 }
 
 void EdgeFilter::setMethod(int method)
@@ -805,9 +1098,9 @@ const char* AlphaFilter::operation_label[AlphaFilter::ALPHA_INVALID] = {
 };
 
 std::vector< FilteringProgram > AlphaFilter::programs_ = {
-    FilteringProgram("Chromakey","shaders/filters/chromakey.glsl",   "",  { { "Red", 0.0}, { "Green", 1.0}, { "Blue", 0.0}, { "Threshold", 0.5}, { "Tolerance", 0.5} }),
-    FilteringProgram("Lumakey",  "shaders/filters/lumakey.glsl",     "",  { { "Threshold", 0.5}, { "Tolerance", 0.5} } ),
-    FilteringProgram("coloralpha","shaders/filters/coloralpha.glsl", "",  { { "Red", 0.0}, { "Green", 1.0}, { "Blue", 0.0} })
+    FilteringProgram("Chromakey","shaders/filters/chromakey.glsl",   "",  { { "Red", 0.0}, { "Green", 1.0}, { "Blue", 0.0}, { "Threshold", 0.5}, { "Tolerance", 0.5} }, true),
+    FilteringProgram("Lumakey",  "shaders/filters/lumakey.glsl",     "",  { { "Threshold", 0.5}, { "Tolerance", 0.5} }, true ),
+    FilteringProgram("coloralpha","shaders/filters/coloralpha.glsl", "",  { { "Red", 0.0}, { "Green", 1.0}, { "Blue", 0.0} }, true)
 };
 
 AlphaFilter::AlphaFilter (): ImageFilter(), operation_(ALPHA_INVALID)
@@ -836,4 +1129,121 @@ void AlphaFilter::accept (Visitor& v)
 }
 
 
+////////////////////////////////////////
+/////                                 //
+////  FUSED POINTWISE FILTERS        ///
+///                                 ////
+////////////////////////////////////////
+
+FusedFilter::FusedFilter (const std::vector<ImageFilter *> &stages): ImageFilter(), stages_(stages)
+{
+    for (auto s = stages_.begin(); s != stages_.end(); ++s)
+        programs_.push_back( (*s)->program() );
+
+    setProgram( FilteringProgram::fuse(programs_) );
+}
+
+void FusedFilter::draw (FrameBuffer *input)
+{
+    // follow changes of the stages (code is generated again only if changed)
+    bool changed = false;
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        if ( programs_[i] != stages_[i]->program() ) {
+            programs_[i] = stages_[i]->program();
+            changed = true;
+        }
+        else
+            programs_[i].setParameters( stages_[i]->program().parameters() );
+    }
+
+    if (changed)
+        setProgram( FilteringProgram::fuse(programs_) );
+    else
+        setProgramParameters( FilteringProgram::fuseParameters(programs_) );
+
+    setEnabled( stages_.front()->enabled() );
+
+    ImageFilter::draw( input );
+}
+
+
+////////////////////////////////////////
+/////                                 //
+////  BENCHMARK OF FILTERS           ///
+///                                 ////
+////////////////////////////////////////
+
+// GPU time (in milliseconds) to draw the filter, averaged over frames
+double gpuTime(ImageFilter *filter, FrameBuffer *input, int frames)
+{
+    // first draw compiles shaders and creates frame buffers
+    filter->draw(input);
+    glFinish();
+
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    for (int i = 0; i < frames; ++i)
+        filter->draw(input);
+    glEndQuery(GL_TIME_ELAPSED);
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    glDeleteQueries(1, &query);
+
+    return double(elapsed) / double(frames) / 1000000.0;
+}
 
+// time each method with fragment shader and with compute shader
+template<class F>
+void benchmarkMethods(std::ostringstream &report, const char *family, const char **labels, int count,
+                      FrameBuffer *input, int frames)
+{
+    for (int m = 0; m < count; ++m) {
+        F filter;
+        filter.setMethod(m);
+
+        char line[256];
+        Settings::application.render.compute_filters = false;
+        double fragment = gpuTime(&filter, input, frames);
+        if ( filter.program().isPointwise() || !ShadingProgram::computeSupported() )
+            snprintf(line, 256, "%-8s %-16s %9.3f ms         -\n", family, labels[m], fragment);
+        else {
+            Settings::application.render.compute_filters = true;
+            double compute = gpuTime(&filter, input, frames);
+            snprintf(line, 256, "%-8s %-16s %9.3f ms %9.3f ms  (x%.2f)\n", family, labels[m],
+                     fragment, compute, fragment / compute);
+        }
+        report << line;
+    }
+}
+
+std::string ImageFilter::benchmark(int width, int height, int frames)
+{
+    std::ostringstream report;
+    report << "Filters at " << width << " x " << height << ", average of " << frames << " frames\n";
+    if ( !ShadingProgram::computeSupported() )
+        report << "Compute shaders not supported (OpenGL 4.3 required)\n";
+    report << "Filter   Method            Fragment    Compute\n";
+
+    // input image of random pixels (worst case for filters skipping flat areas)
+    FrameBuffer *input = new FrameBuffer(width, height, FrameBuffer::FrameBuffer_alpha);
+    input->begin();
+    input->end();
+    std::vector<guint32> pixels( width * height );
+    for (auto p = pixels.begin(); p != pixels.end(); ++p)
+        *p = g_random_int();
+    glBindTexture(GL_TEXTURE_2D, input->texture());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    bool compute = Settings::application.render.compute_filters;
+    benchmarkMethods<SmoothFilter>(report, "Smooth", SmoothFilter::method_label, SmoothFilter::SMOOTH_INVALID, input, frames);
+    benchmarkMethods<SharpenFilter>(report, "Sharpen", SharpenFilter::method_label, SharpenFilter::SHARPEN_INVALID, input, frames);
+    benchmarkMethods<EdgeFilter>(report, "Edge", EdgeFilter::method_label, EdgeFilter::EDGE_INVALID, input, frames);
+    Settings::application.render.compute_filters = compute;
+
+    delete input;
+
+    return report.str();
+}
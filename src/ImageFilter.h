@@ -23,6 +23,9 @@ class FilteringProgram
     // true if code is given for second pass
     bool two_pass_filter_;
 
+    // true if code only reads the input at the pixel drawn
+    bool pointwise_;
+
     // list of parameters : uniforms names and values
     std::map< std::string, float > parameters_;
 
@@ -30,7 +33,7 @@ public:
 
     FilteringProgram();
     FilteringProgram(const std::string &name, const std::string &first_pass, const std::string &second_pass,
-                     const std::map<std::string, float> &parameters);
+                     const std::map<std::string, float> &parameters, bool pointwise = false);
     FilteringProgram(const FilteringProgram &other);
 
     FilteringProgram& operator= (const FilteringProgram& other);
@@ -49,6 +52,9 @@ public:
     // if has second pass
     bool isTwoPass() const { return two_pass_filter_; }
 
+    // if can be fused with other pointwise programs
+    bool isPointwise() const { return pointwise_; }
+
     // set the list of parameters
     inline void setParameters(const std::map< std::string, float > &parameters) { parameters_ = parameters; }
 
@@ -63,6 +69,10 @@ public:
     static std::string getFilterCodeDefault();
     static std::list< FilteringProgram > presets;
     static glm::vec4 iMouse;
+
+    // generate a single-pass program applying the given pointwise programs in sequence
+    static FilteringProgram fuse(const std::vector<FilteringProgram> &programs);
+    static std::map< std::string, float > fuseParameters(const std::vector<FilteringProgram> &programs);
 };
 
 class Surface;
@@ -72,10 +82,13 @@ class ImageFilteringShader : public ImageShader
 {
     // GLSL Program
     ShadingProgram custom_shading_;
+    ShadingProgram compute_shading_;
 
     // fragment shader GLSL code
     std::string shader_code_;
     std::string code_;
+    // compute shader GLSL code
+    std::string compute_code_;
 
 public:
     // for iTimedelta
@@ -98,6 +111,10 @@ public:
     // set the code of the filter
     void setCode(const std::string &code, std::promise<std::string> *ret = nullptr);
 
+    // render the filter of input texture into output with a compute shader
+    // returns false if not possible (output must be RGBA without multisampling)
+    bool dispatch(uint input, FrameBuffer *output);
+
 };
 
 
@@ -113,8 +130,8 @@ public:
 
     // set the program
     void setProgram(const FilteringProgram &f, std::promise<std::string> *ret = nullptr);
-    // get copy of the program
-    FilteringProgram program() const;
+    // get the program
+    const FilteringProgram &program() const;
 
     // update parameters of program
     void setProgramParameters(const std::map< std::string, float > &parameters);
@@ -124,14 +141,23 @@ public:
     Type type() const override { return FrameBufferFilter::FILTER_IMAGE; }
     uint texture () const override;
     glm::vec3 resolution () const override;
+    FrameBuffer *frame () const override;
     void update (float dt) override;
     double updateTime () override;
     void reset () override;
     void draw   (FrameBuffer *input) override;
     void accept (Visitor& v) override;
 
+    // compare fragment and compute shaders of smooth, sharpen and edge filters
+    static std::string benchmark(int width, int height, int frames = 100);
+
 protected:
 
+    // use compute shaders if possible (for neighborhood filters)
+    bool compute_;
+    bool computing_;
+    bool computing () const;
+
     std::pair< Surface *, Surface *> surfaces_;
     std::pair< FrameBuffer *, FrameBuffer * > buffers_;
     std::pair< ImageFilteringShader *, ImageFilteringShader *> shaders_;
@@ -139,6 +165,22 @@ protected:
 };
 
 
+class FusedFilter : public ImageFilter
+{
+public:
+
+    // apply pointwise image filters in sequence in a single pass
+    FusedFilter(const std::vector<ImageFilter *> &stages);
+
+    // implementation of FrameBufferFilter
+    void draw   (FrameBuffer *input) override;
+
+private:
+    std::vector<ImageFilter *> stages_;
+    std::vector<FilteringProgram> programs_;
+};
+
+
 class ResampleFilter : public ImageFilter
 {
 public:
@@ -189,6 +231,16 @@ public:
     BlurMethod method () const { return method_; }
     void setMethod(int method);
 
+    // Quality of gaussian blur (Settings::application.render.blur_quality)
+    typedef enum {
+        BLUR_QUALITY_LOW = 0,
+        BLUR_QUALITY_MEDIUM,
+        BLUR_QUALITY_HIGH,
+        BLUR_QUALITY_INVALID
+    } BlurQuality;
+    static const char* quality_label[BLUR_QUALITY_INVALID];
+    static const int quality_taps[BLUR_QUALITY_INVALID];
+
     // implementation of FrameBufferFilter
     Type type() const override { return FrameBufferFilter::FILTER_BLUR; }
 
@@ -201,6 +253,7 @@ private:
 
     Surface *mipmap_surface_;
     FrameBuffer *mipmap_buffer_;
+    FrameBuffer *downsampled_buffer_;
 };
 
 
@@ -77,6 +77,19 @@ void ImageProcessingShader::copy(ImageProcessingShader const& S)
     levels = S.levels;
 }
 
+bool ImageProcessingShader::equals(ImageProcessingShader const& S) const
+{
+    return brightness == S.brightness &&
+           contrast == S.contrast &&
+           saturation == S.saturation &&
+           hueshift == S.hueshift &&
+           threshold == S.threshold &&
+           nbColors == S.nbColors &&
+           invert == S.invert &&
+           gamma == S.gamma &&
+           levels == S.levels;
+}
+
 
 void ImageProcessingShader::accept(Visitor& v)
 {
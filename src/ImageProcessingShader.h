@@ -14,6 +14,7 @@ public:
     void accept(Visitor& v) override;
 
     void copy(ImageProcessingShader const& S);
+    bool equals(ImageProcessingShader const& S) const;
 
     // color effects
     float brightness; // [-1 1]
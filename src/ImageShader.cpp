@@ -28,6 +28,7 @@
 
 ShadingProgram imageShadingProgram("shaders/image.vs", "shaders/image.fs");
 ShadingProgram imageAlphaProgram  ("shaders/image.vs", "shaders/imageblending.fs");
+ShadingProgram imageYuvProgram    ("shaders/image.vs", "shaders/yuv.fs");
 std::vector< ShadingProgram > maskPrograms = {
     ShadingProgram("shaders/simple.vs", "shaders/simple.fs"),
     ShadingProgram("shaders/image.vs",  "shaders/mask_draw.fs"),
@@ -102,6 +103,48 @@ AlphaShader::AlphaShader(): ImageShader()
 }
 
 
+YuvShader::YuvShader(): Shader(), planes(2)
+{
+    // static program shader
+    program_ = &imageYuvProgram;
+    // reset instance
+    YuvShader::reset();
+
+    // conversion outputs opaque RGB
+    blending = Shader::BLEND_NONE;
+}
+
+void YuvShader::use()
+{
+    Shader::use();
+
+    // planes and colorimetry
+    program_->setUniform("planes", int(planes));
+    program_->setUniform("yuvtorgb", yuvtorgb);
+    program_->setUniform("iChannel2", 2);
+
+    // setup chroma textures
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture  (GL_TEXTURE_2D, chroma_texture[0]);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture  (GL_TEXTURE_2D, planes > 2 ? chroma_texture[1] : chroma_texture[0]);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void YuvShader::reset()
+{
+    Shader::reset();
+
+    chroma_texture[0] = chroma_texture[1] = 0;
+
+    // default to BT.601 limited range
+    yuvtorgb = glm::mat4( 1.164f, 1.164f, 1.164f, 0.f,
+                          0.f, -0.392f, 2.017f, 0.f,
+                          1.596f, -0.813f, 0.f, 0.f,
+                          -0.874f, 0.532f, -1.086f, 1.f );
+}
+
+
 MaskShader::MaskShader(): Shader(), mode(0)
 {
     // reset instance
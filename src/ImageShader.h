@@ -33,6 +33,25 @@ public:
 };
 
 
+class YuvShader : public Shader
+{
+
+public:
+    YuvShader();
+
+    void use() override;
+    void reset() override;
+
+    // number of planes (2 for NV12 and P010, 3 for I420)
+    uint planes;
+    // textures of the chroma planes (U and V, or interleaved UV)
+    uint chroma_texture[2];
+
+    // uniforms
+    glm::mat4 yuvtorgb;
+};
+
+
 class MaskShader : public Shader
 {
 
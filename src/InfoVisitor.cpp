@@ -248,7 +248,9 @@ void InfoVisitor::visit (CloneSource& s)
             if (s.origin())
                 oss << "Clone of '" << s.origin()->name() << "' " << std::endl;
             oss << (s.frame()->flags() & FrameBuffer::FrameBuffer_alpha ? "RGBA, " : "RGB, ");
-            oss << std::get<2>(FrameBufferFilter::Types[s.filter()->type()]) << " filter" << std::endl;
+            for (size_t i = 0; i < s.numFilters(); ++i)
+                oss << (i > 0 ? " + " : "") << std::get<2>(FrameBufferFilter::Types[s.filter(i)->type()]);
+            oss << (s.numFilters() > 1 ? " filters" : " filter") << std::endl;
             oss << s.frame()->width() << " x " << s.frame()->height();
         }
     }
@@ -17,9 +17,16 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
 **/
 
+#include <map>
+
 //  Desktop OpenGL function loader
 #include <glad/glad.h>
 
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <tinyxml2.h>
+#include "tinyxml2Toolkit.h"
+
 #include "defines.h"
 #include "Log.h"
 #include "Resource.h"
@@ -28,6 +35,12 @@
 #include "BaseToolkit.h"
 #include "GstToolkit.h"
 #include "Metronome.h"
+#include "Settings.h"
+#include "FrameBuffer.h"
+#include "Primitives.h"
+#include "ImageShader.h"
+#include "FrameCache.h"
+#include "MediaProxy.h"
 
 #include "MediaPlayer.h"
 
@@ -38,14 +51,16 @@
 #define DISCOVER_TIMOUT 15
 
 std::list<MediaPlayer*> MediaPlayer::registered_;
+std::list<MediaPlayer*> MediaPlayer::prerolled_pool_;
 
-MediaPlayer::MediaPlayer()
+MediaPlayer::MediaPlayer() : frame_queue_(new FrameQueue(N_VFRAME))
 {
     // create unique id
     id_ = BaseToolkit::uniqueId();
 
     uri_ = "undefined";
     pipeline_ = nullptr;
+    v_frame_caps_ = NULL;
     opened_ = false;
     enabled_ = true;
     desired_state_ = GST_STATE_PAUSED;
@@ -56,37 +71,75 @@ MediaPlayer::MediaPlayer()
     force_update_ = false;
     seeking_ = false;
     rewind_on_disable_ = false;
+    gapless_ = false;
     force_software_decoding_ = false;
+    hw_fallback_ = false;
+    decoding_error_ = false;
+    frame_time_ = 0;
+    hw_frames_ = 0;
+    hw_stalls_ = 0;
+    hw_stalled_ = false;
+    resume_position_ = GST_CLOCK_TIME_NONE;
+    yuv_upload_ = false;
+    prerolled_ = false;
+    preroll_pending_ = false;
+    released_ = false;
+    decode_limit_ = DECODE_FULL;
+    leader_ = nullptr;
+    display_height_ = 0;
+    decode_height_ = 0;
     decoder_name_ = "";
     rate_ = 1.0;
     position_ = GST_CLOCK_TIME_NONE;
     loop_ = LoopMode::LOOP_REWIND;
 
-    // start index in frame_ stack
-    write_index_ = 0;
-    last_index_ = 0;
+    // no frame from cache
+    cache_target_ = GST_CLOCK_TIME_NONE;
+    cache_clock_ = GST_CLOCK_TIME_NONE;
+    cache_time_ = 0;
+    cache_playback_ = false;
+    cache_resync_ = false;
+    cache_fill_ = false;
+    cache_history_ = GST_CLOCK_TIME_NONE;
 
     // no PBO by default
     pbo_[0] = pbo_[1] = 0;
     pbo_size_ = 0;
     pbo_index_ = 0;
     pbo_next_index_ = 0;
+    frame_width_ = frame_height_ = 0;
+
+    // no YUV planes by default
+    yuv_planes_ = 0;
+    yuv_textures_[0] = yuv_textures_[1] = yuv_textures_[2] = 0;
+    yuv_offset_[0] = yuv_offset_[1] = yuv_offset_[2] = 0;
+    yuv_buffer_ = nullptr;
+    yuv_surface_ = nullptr;
+    yuv_shader_ = nullptr;
 
     // OpenGL texture
     textureindex_ = 0;
+    frame_count_ = 0;
 }
 
 MediaPlayer::~MediaPlayer()
 {
     close();
 
-    // cleanup opengl texture
-    if (textureindex_)
-        glDeleteTextures(1, &textureindex_);
+    // leave pool of prerolled players
+    if (prerolled_)
+        MediaPlayer::prerolled_pool_.remove(this);
 
-    // cleanup picture buffer
-    if (pbo_[0])
-        glDeleteBuffers(2, pbo_);
+    // cleanup opengl textures and picture buffers
+    release_texture();
+
+    // cleanup YUV conversion
+    if (yuv_buffer_)
+        delete yuv_buffer_;
+
+    // frames of the last pipeline (if any) were given to its termination
+    delete frame_queue_.load();
+    gst_caps_replace (&v_frame_caps_, NULL);
 }
 
 void MediaPlayer::accept(Visitor& v) {
@@ -95,12 +148,358 @@ void MediaPlayer::accept(Visitor& v) {
 
 guint MediaPlayer::texture() const
 {
+    // frames decoded by the player followed
+    if (leader_ != nullptr)
+        return leader_->texture();
+
+    // YUV planes are converted into RGB frame buffer
+    if (yuv_buffer_ != nullptr)
+        return yuv_buffer_->texture();
+
     if (textureindex_ == 0)
         return Resource::getTextureBlack();
 
     return textureindex_;
 }
 
+uint64_t MediaPlayer::frameCount() const
+{
+    // frames decoded by the player followed
+    if (leader_ != nullptr)
+        return leader_->frameCount();
+
+    return frame_count_;
+}
+
+#define MAX_MEDIA_CACHE 1000
+#define MEDIA_CACHE_SAVE_DELAY 30000000
+
+//
+// Persistent cache of MediaInfo, stored in settings path.
+// Entries are indexed by filename and valid as long as the
+// size and modification time of the file are unchanged.
+// Changes are saved at most every 30 seconds, and at exit.
+//
+struct MediaInfoCache
+{
+    struct Entry {
+        unsigned long long size;
+        long long mtime;
+        long long used;
+        MediaInfo info;
+    };
+
+    std::map<std::string, Entry> entries_;
+    std::mutex access_;
+    std::mutex saving_;
+    bool loaded_;
+    bool dirty_;
+    gint64 saved_;
+
+    MediaInfoCache() : loaded_(false), dirty_(false), saved_(0) {}
+    ~MediaInfoCache() { flush(); }
+
+    static MediaInfoCache& instance()
+    {
+        static MediaInfoCache _instance;
+        return _instance;
+    }
+
+    static std::string filename()
+    {
+        return SystemToolkit::full_filename(SystemToolkit::settings_path(), MEDIA_CACHE_FILE);
+    }
+
+    // get valid info of file; false if unknown or file changed
+    bool find(const std::string &path, MediaInfo &info);
+    // remember info of file
+    void insert(const std::string &path, const MediaInfo &info);
+    // save changes to file
+    void flush();
+
+private:
+    void load();
+    static void save(const std::map<std::string, Entry> &entries);
+};
+
+bool MediaInfoCache::find(const std::string &path, MediaInfo &info)
+{
+    unsigned long long size = 0;
+    long long mtime = 0;
+    if ( !SystemToolkit::file_status(path, size, mtime) )
+        return false;
+
+    std::lock_guard<std::mutex> lock(access_);
+    if (!loaded_)
+        load();
+
+    auto it = entries_.find(path);
+    if (it == entries_.end())
+        return false;
+
+    // entry is forgotten or its use is updated: save it
+    dirty_ = true;
+
+    // file changed since discovery: forget it
+    if (it->second.size != size || it->second.mtime != mtime) {
+        entries_.erase(it);
+        return false;
+    }
+
+    // keep order of use for next time
+    it->second.used = g_get_real_time() / G_USEC_PER_SEC;
+    info = it->second.info;
+    return true;
+}
+
+void MediaInfoCache::insert(const std::string &path, const MediaInfo &info)
+{
+    Entry e;
+    if ( !SystemToolkit::file_status(path, e.size, e.mtime) )
+        return;
+    e.used = g_get_real_time() / G_USEC_PER_SEC;
+    e.info = info;
+    e.info.log = "";
+
+    bool due = false;
+    {
+        std::lock_guard<std::mutex> lock(access_);
+        if (!loaded_)
+            load();
+
+        entries_[path] = e;
+
+        // limit size: forget the entry not used for the longest time
+        while (entries_.size() > MAX_MEDIA_CACHE) {
+            auto oldest = entries_.begin();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                if (it->second.used < oldest->second.used)
+                    oldest = it;
+            }
+            entries_.erase(oldest);
+        }
+
+        dirty_ = true;
+        due = g_get_monotonic_time() - saved_ > MEDIA_CACHE_SAVE_DELAY;
+    }
+
+    // do not write file for every new media
+    if (due)
+        flush();
+}
+
+void MediaInfoCache::flush()
+{
+    // one file writer at a time
+    std::lock_guard<std::mutex> writing(saving_);
+
+    // copy entries to save, without blocking access
+    std::map<std::string, Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(access_);
+        if (!dirty_)
+            return;
+        entries = entries_;
+        dirty_ = false;
+        saved_ = g_get_monotonic_time();
+    }
+
+    save(entries);
+}
+
+void MediaInfoCache::load()
+{
+    loaded_ = true;
+
+    tinyxml2::XMLDocument xmlDoc;
+    if ( xmlDoc.LoadFile(filename().c_str()) != tinyxml2::XML_SUCCESS )
+        return;
+
+    tinyxml2::XMLElement *cache = xmlDoc.FirstChildElement("MediaCache");
+    if (cache == nullptr)
+        return;
+
+    tinyxml2::XMLElement *media = cache->FirstChildElement("Media");
+    for ( ; media ; media = media->NextSiblingElement("Media") ) {
+        const char *path = media->Attribute("path");
+        if (path == nullptr)
+            continue;
+        uint64_t size = 0, dt = GST_CLOCK_TIME_NONE, end = GST_CLOCK_TIME_NONE;
+        int64_t mtime = 0, used = 0;
+        media->QueryUnsigned64Attribute("size", &size);
+        media->QueryInt64Attribute("mtime", &mtime);
+        media->QueryInt64Attribute("used", &used);
+        media->QueryUnsigned64Attribute("dt", &dt);
+        media->QueryUnsigned64Attribute("end", &end);
+        Entry e;
+        e.size = size;
+        e.mtime = mtime;
+        e.used = used;
+        e.info.dt = dt;
+        e.info.end = end;
+        media->QueryUnsignedAttribute("width", &e.info.width);
+        media->QueryUnsignedAttribute("par_width", &e.info.par_width);
+        media->QueryUnsignedAttribute("height", &e.info.height);
+        media->QueryUnsignedAttribute("bitrate", &e.info.bitrate);
+        media->QueryUnsignedAttribute("framerate_n", &e.info.framerate_n);
+        media->QueryUnsignedAttribute("framerate_d", &e.info.framerate_d);
+        media->QueryBoolAttribute("isimage", &e.info.isimage);
+        media->QueryBoolAttribute("interlaced", &e.info.interlaced);
+        media->QueryBoolAttribute("seekable", &e.info.seekable);
+        const char *codec = media->Attribute("codec");
+        if (codec)
+            e.info.codec_name = std::string(codec);
+        e.info.valid = true;
+        entries_[std::string(path)] = e;
+    }
+}
+
+void MediaInfoCache::save(const std::map<std::string, Entry> &entries)
+{
+    tinyxml2::XMLDocument xmlDoc;
+    tinyxml2::XMLElement *cache = xmlDoc.NewElement("MediaCache");
+    xmlDoc.InsertEndChild(cache);
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        tinyxml2::XMLElement *media = xmlDoc.NewElement("Media");
+        media->SetAttribute("path", it->first.c_str());
+        media->SetAttribute("size", (uint64_t) it->second.size);
+        media->SetAttribute("mtime", (int64_t) it->second.mtime);
+        media->SetAttribute("used", (int64_t) it->second.used);
+        media->SetAttribute("width", it->second.info.width);
+        media->SetAttribute("par_width", it->second.info.par_width);
+        media->SetAttribute("height", it->second.info.height);
+        media->SetAttribute("bitrate", it->second.info.bitrate);
+        media->SetAttribute("framerate_n", it->second.info.framerate_n);
+        media->SetAttribute("framerate_d", it->second.info.framerate_d);
+        media->SetAttribute("isimage", it->second.info.isimage);
+        media->SetAttribute("interlaced", it->second.info.interlaced);
+        media->SetAttribute("seekable", it->second.info.seekable);
+        media->SetAttribute("dt", (uint64_t) it->second.info.dt);
+        media->SetAttribute("end", (uint64_t) it->second.info.end);
+        media->SetAttribute("codec", it->second.info.codec_name.c_str());
+        cache->InsertEndChild(media);
+    }
+
+    tinyxml2::XMLError eResult = xmlDoc.SaveFile(filename().c_str());
+    tinyxml2::XMLResultError(eResult);
+}
+
+#define DECODER_FAILURE_EXPIRY (7 * 24 * 3600)
+
+//
+// Persistent record of hardware decoding, stored in settings path.
+// Entries are indexed by codec and resolution; a hardware decoder
+// that failed at runtime is not used for that codec during a week
+// (e.g. until drivers are updated).
+//
+struct HardwareDecoderCache
+{
+    struct Entry {
+        bool hardware;
+        long long time;
+    };
+
+    std::map<std::string, Entry> entries_;
+    std::mutex access_;
+    bool loaded_;
+
+    HardwareDecoderCache() : loaded_(false) {}
+
+    static HardwareDecoderCache& instance()
+    {
+        static HardwareDecoderCache _instance;
+        return _instance;
+    }
+
+    static std::string filename()
+    {
+        return SystemToolkit::full_filename(SystemToolkit::settings_path(), DECODER_CACHE_FILE);
+    }
+
+    // true if hardware decoding failed recently for this codec
+    bool failed(const std::string &codec);
+    // remember success or failure of hardware decoding for this codec
+    void set(const std::string &codec, bool success);
+
+private:
+    void load();
+    void save();
+};
+
+bool HardwareDecoderCache::failed(const std::string &codec)
+{
+    std::lock_guard<std::mutex> lock(access_);
+    if (!loaded_)
+        load();
+
+    auto it = entries_.find(codec);
+    if (it == entries_.end() || it->second.hardware)
+        return false;
+
+    // failure expired: try hardware decoding again
+    return g_get_real_time() / G_USEC_PER_SEC - it->second.time < DECODER_FAILURE_EXPIRY;
+}
+
+void HardwareDecoderCache::set(const std::string &codec, bool success)
+{
+    std::lock_guard<std::mutex> lock(access_);
+    if (!loaded_)
+        load();
+
+    // nothing new
+    auto it = entries_.find(codec);
+    if (it != entries_.end() && it->second.hardware && success)
+        return;
+
+    entries_[codec] = { success, g_get_real_time() / G_USEC_PER_SEC };
+    save();
+}
+
+void HardwareDecoderCache::load()
+{
+    loaded_ = true;
+
+    tinyxml2::XMLDocument xmlDoc;
+    if ( xmlDoc.LoadFile(filename().c_str()) != tinyxml2::XML_SUCCESS )
+        return;
+
+    tinyxml2::XMLElement *cache = xmlDoc.FirstChildElement("DecoderCache");
+    if (cache == nullptr)
+        return;
+
+    tinyxml2::XMLElement *decoder = cache->FirstChildElement("Decoder");
+    for ( ; decoder ; decoder = decoder->NextSiblingElement("Decoder") ) {
+        const char *codec = decoder->Attribute("codec");
+        if (codec == nullptr)
+            continue;
+        Entry e = { true, 0 };
+        int64_t time = 0;
+        decoder->QueryBoolAttribute("hardware", &e.hardware);
+        decoder->QueryInt64Attribute("time", &time);
+        e.time = time;
+        entries_[std::string(codec)] = e;
+    }
+}
+
+void HardwareDecoderCache::save()
+{
+    tinyxml2::XMLDocument xmlDoc;
+    tinyxml2::XMLElement *cache = xmlDoc.NewElement("DecoderCache");
+    xmlDoc.InsertEndChild(cache);
+
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        tinyxml2::XMLElement *decoder = xmlDoc.NewElement("Decoder");
+        decoder->SetAttribute("codec", it->first.c_str());
+        decoder->SetAttribute("hardware", it->second.hardware);
+        decoder->SetAttribute("time", (int64_t) it->second.time);
+        cache->InsertEndChild(decoder);
+    }
+
+    tinyxml2::XMLError eResult = xmlDoc.SaveFile(filename().c_str());
+    tinyxml2::XMLResultError(eResult);
+}
+
 #define LIMIT_DISCOVERER
 
 MediaInfo MediaPlayer::UriDiscoverer(const std::string &uri)
@@ -109,6 +508,26 @@ MediaInfo MediaPlayer::UriDiscoverer(const std::string &uri)
     Log::Info("Checking file '%s'", uri.c_str());
 #endif
 
+    // local files could have been discovered before
+    std::string path;
+    if ( gst_uri_has_protocol(uri.c_str(), "file") ) {
+        gchar *location = gst_uri_get_location(uri.c_str());
+        if (location) {
+            path = std::string(location);
+            g_free(location);
+        }
+    }
+
+    if ( !path.empty() ) {
+        MediaInfo cached_info;
+        if ( MediaInfoCache::instance().find(path, cached_info) ) {
+#ifdef MEDIA_PLAYER_DEBUG
+            Log::Info("Found '%s' in media cache", path.c_str());
+#endif
+            return cached_info;
+        }
+    }
+
 #ifdef LIMIT_DISCOVERER
     // Limiting the number of discoverer thread to TWO in parallel
     // Otherwise, a large number of discoverers are executed (when loading a file)
@@ -240,6 +659,11 @@ MediaInfo MediaPlayer::UriDiscoverer(const std::string &uri)
     else
         mtx_secondary.unlock();
 #endif
+
+    // remember valid info for next time
+    if ( video_stream_info.valid && !path.empty() )
+        MediaInfoCache::instance().insert(path, video_stream_info);
+
     // return the info
     return video_stream_info;
 }
@@ -250,8 +674,15 @@ void MediaPlayer::open (const std::string & filename, const std::string &uri)
     filename_ = BaseToolkit::transliterate( filename );
 
     // set uri to open
-    if (uri.empty())
-        uri_ = GstToolkit::filename_to_uri( filename );
+    if (uri.empty()) {
+        // open the intra-frame proxy of the file if there is one
+        std::string proxy;
+        if (Settings::application.source.proxy)
+            proxy = MediaProxy::manager().find( filename );
+        if (!proxy.empty())
+            Log::Info("MediaPlayer %s Using proxy '%s'.", std::to_string(id_).c_str(), proxy.c_str());
+        uri_ = GstToolkit::filename_to_uri( proxy.empty() ? filename : proxy );
+    }
     else
         uri_ = uri;
 
@@ -309,6 +740,10 @@ void MediaPlayer::execute_open()
     if (media_.interlaced)
         description += "deinterlace method=2 ! ";
 
+    // scale down to decode resolution before color conversion (caps set in execute_decode_scale)
+    if (!media_.isimage)
+        description += "videoscale method=1 ! capsfilter name=scale ! ";
+
     // video convertion algorithm (should only do colorspace conversion, no scaling)
     // chroma-resampler:
     //      Duplicates the samples when upsampling and drops when downsampling 0
@@ -321,6 +756,7 @@ void MediaPlayer::execute_open()
     //      Dither with floyd-steinberg error diffusion 2
     //      Dither with Sierra Lite error diffusion 3
     //      ordered dither using a bayer pattern 4 (default)
+    // NB: with YUV upload, videoconvert is passthrough for natively supported formats
     description += "videoconvert chroma-resampler=1 dither=0 ! "; // fast
 
     // hack to compensate for lack of PTS in gif animations
@@ -346,20 +782,34 @@ void MediaPlayer::execute_open()
     g_object_set(G_OBJECT(pipeline_), "name", std::to_string(id_).c_str(), NULL);
     gst_pipeline_set_auto_flush_bus( GST_PIPELINE(pipeline_), true);
 
+    // option to keep YUV planes and convert to RGB on GPU (not for images; decoded once)
+    // NB: upload mode cannot change when re-openning after textures were created
+    if (textureindex_ < 1 && yuv_planes_ < 1)
+        yuv_upload_ = Settings::application.render.yuv_upload && !media_.isimage;
+
     // GstCaps *caps = gst_static_caps_get (&frame_render_caps);
-    std::string capstring = "video/x-raw,format=RGBA,width="+ std::to_string(media_.width) +
-            ",height=" + std::to_string(media_.height);
+    // NB: frame size depends on decode resolution; it is negotiated with format
+    // and video info is set from caps of samples
+    std::string capstring = "video/x-raw,format=RGBA";
+    if (yuv_upload_)
+        capstring = "video/x-raw,format=(string){NV12,I420,P010_10LE}";
     GstCaps *caps = gst_caps_from_string(capstring.c_str());
-    if (!gst_video_info_from_caps (&v_frame_video_info_, caps)) {
-        Log::Warning("MediaPlayer %s Could not configure video frame info", std::to_string(id_).c_str());
-        failed_ = true;
-        return;
-    }
+    gst_video_info_init (&v_frame_video_info_);
+    gst_caps_replace (&v_frame_caps_, NULL);
+
+    // initial decode resolution
+    decode_height_ = 0;
+    execute_decode_scale();
 
-    // setup software decode
-    if (force_software_decoding_) {
+    // setup software decode (forced, or hardware decoder failed before for this codec or this player)
+    hw_fallback_ = !force_software_decoding_ && !media_.isimage && Settings::application.render.gpu_decoding
+            && ( hw_stalled_ || HardwareDecoderCache::instance().failed( decoder_key() ) );
+    if (force_software_decoding_ || hw_fallback_) {
         g_object_set (G_OBJECT (gst_bin_get_by_name (GST_BIN (pipeline_), "decoder")), "force-sw-decoders", true,  NULL);
     }
+    if (hw_fallback_)
+        Log::Info("MediaPlayer %s Hardware decoding of %s failed before; using software decoding.",
+                  std::to_string(id_).c_str(), decoder_key().c_str());
 
     // setup appsink
     GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline_), "sink");
@@ -413,6 +863,15 @@ void MediaPlayer::execute_open()
         return;
     }
 
+    // new pipeline is not released
+    released_ = false;
+
+    // start monitoring decoding
+    decoding_error_ = false;
+    frame_time_ = g_get_monotonic_time();
+    hw_frames_ = 0;
+    hw_stalls_ = 0;
+
     // in case discoverer failed to get duration
     if (timeline_.end() == GST_CLOCK_TIME_NONE) {
         gint64 d = GST_CLOCK_TIME_NONE;
@@ -432,6 +891,10 @@ void MediaPlayer::execute_open()
 
     // register media player
     MediaPlayer::registered_.push_back(this);
+
+    // preroll was requested before opening
+    if (prerolled_)
+        execute_preroll();
 }
 
 bool MediaPlayer::isOpen() const
@@ -444,23 +907,19 @@ bool MediaPlayer::failed() const
     return failed_;
 }
 
-void MediaPlayer::Frame::unmap()
-{
-    if ( full )
-        gst_video_frame_unmap(&vframe);
-    full = false;
-}
-
 
-void delayed_terminate( GstElement *p )
+void delayed_terminate( GstElement *p, FrameQueue *q )
 {
     GstElement *__pipeline = p;
 
-    // end pipeline
+    // end pipeline (streaming threads are stopped when done)
     gst_element_set_state (__pipeline, GST_STATE_NULL);
 
     // unref to free pipeline
     gst_object_unref ( GST_OBJECT (__pipeline) );
+
+    // no more producer: free frames of the pipeline
+    delete q;
 }
 
 
@@ -479,6 +938,9 @@ void MediaPlayer::close()
     // un-ready the media player
     opened_ = false;
 
+    // followers continue with their own decoder
+    unshare();
+
     // clean up GST
     if (pipeline_ != nullptr) {
 
@@ -490,20 +952,30 @@ void MediaPlayer::close()
         //        gst_element_set_state (pipeline_, GST_STATE_NULL);
         //        gst_object_unref ( GST_OBJECT (pipeline_) );
 
-        // end pipeline asynchronously // TODO more stress test?
-        std::thread(delayed_terminate, pipeline_).detach();
+        // stop sending samples to this player
+        GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline_), "sink");
+        if (sink) {
+            GstAppSinkCallbacks callbacks = {};
+            gst_app_sink_set_callbacks (GST_APP_SINK(sink), &callbacks, NULL, NULL);
+            gst_object_unref (sink);
+        }
+
+        // end pipeline asynchronously; the streaming thread can still be
+        // filling a frame, so the frames are freed after the pipeline stops
+        FrameQueue *queue = frame_queue_.exchange( new FrameQueue(N_VFRAME) );
+        std::thread(delayed_terminate, pipeline_, queue).detach();
 
         pipeline_ = nullptr;
     }
-
     // cleanup eventual remaining frame memory
-    for(guint i = 0; i < N_VFRAME; i++) {
-        frame_[i].access.lock();
-        frame_[i].unmap();
-        frame_[i].access.unlock();
-    }
-    write_index_ = 0;
-    last_index_ = 0;
+    else
+        frame_queue_.load()->clear();
+
+    // cleanup frames in cache
+    FrameCache::manager().remove(id_);
+    cache_target_ = GST_CLOCK_TIME_NONE;
+    cache_playback_ = false;
+    cache_resync_ = false;
 
 
 #ifdef MEDIA_PLAYER_DEBUG
@@ -548,12 +1020,26 @@ void MediaPlayer::enable(bool on)
 
     if ( enabled_ != on ) {
 
+        // stop sharing decoder
+        unshare();
+
         // option to automatically rewind each time the player is disabled
         if (!on && rewind_on_disable_ && desired_state_ == GST_STATE_PLAYING)
             rewind(true);
 
         // apply change
         enabled_ = on;
+        frame_time_ = g_get_monotonic_time();
+
+        // stop playing from cache when disabled
+        if (!enabled_ && cache_playback_) {
+            cache_playback_ = false;
+            cache_resync_ = true;
+        }
+
+        // released pipeline is not needed while disabled
+        if (!enabled_ && released_)
+            return;
 
         // default to pause
         GstState requested_state = GST_STATE_PAUSED;
@@ -568,6 +1054,9 @@ void MediaPlayer::enable(bool on)
             Log::Warning("MediaPlayer %s Failed to enable", std::to_string(id_).c_str());
             failed_ = true;
         }
+        // resume decoding where frames from cache stopped
+        else if (enabled_ && cache_resync_)
+            execute_seek_command();
 
     }
 }
@@ -585,7 +1074,7 @@ bool MediaPlayer::isImage() const
 std::string MediaPlayer::decoderName()
 {
     if (pipeline_) {
-        if (force_software_decoding_) {
+        if (force_software_decoding_ || hw_fallback_) {
             decoder_name_ = "software";
         }
         // decoder_name_ not initialized
@@ -631,16 +1120,32 @@ void MediaPlayer::execute_play_command(bool on)
     // accept request to the desired state
     desired_state_ = requested_state;
 
+    // started playing : leave pool of prerolled players
+    if ( desired_state_ == GST_STATE_PLAYING && prerolled_ ) {
+        MediaPlayer::prerolled_pool_.remove(this);
+        prerolled_ = false;
+        preroll_pending_ = false;
+    }
+
     // if not ready yet, the requested state will be handled later
     if ( pipeline_ == nullptr )
         return;
 
+    // stop playing from cache
+    if ( cache_playback_ ) {
+        cache_playback_ = false;
+        cache_resync_ = true;
+    }
+
     // requesting to play, but stopped at end of stream : rewind first !
     if ( desired_state_ == GST_STATE_PLAYING) {
         if (rate_ > 0.0 && position_ >= timeline_.previous(timeline_.last()))
             execute_seek_command(timeline_.next(0));
         else if ( rate_ < 0.0 && position_ <= timeline_.next(0)  )
             execute_seek_command(timeline_.previous(timeline_.last()));
+        // resume decoding where frames from cache stopped
+        else if ( cache_resync_ )
+            execute_seek_command();
     }
 
     // all ready, apply state change immediately
@@ -663,6 +1168,9 @@ void MediaPlayer::play(bool on)
     if (!enabled_ || media_.isimage || pending_)
         return;
 
+    // stop sharing decoder
+    unshare();
+
     // Metronome
     if (metro_sync_ > Metronome::SYNC_NONE) {
         // busy with this delayed action
@@ -681,6 +1189,192 @@ void MediaPlayer::play(bool on)
         execute_play_command( on );
 }
 
+void MediaPlayer::preroll()
+{
+    // cannot preroll an image, and no need to preroll if playing
+    if ( media_.isimage || failed_ || desired_state_ == GST_STATE_PLAYING )
+        return;
+
+    // stop sharing decoder
+    unshare();
+
+    // enter pool of prerolled players
+    if ( !prerolled_ ) {
+        MediaPlayer::prerolled_pool_.push_back(this);
+        prerolled_ = true;
+        // limited number of players in pool: the oldest leaves
+        // and releases its decoder
+        while ( MediaPlayer::prerolled_pool_.size() > N_PREROLL ) {
+            MediaPlayer *p = MediaPlayer::prerolled_pool_.front();
+            p->prerolled_ = false;
+            p->preroll_pending_ = false;
+            MediaPlayer::prerolled_pool_.pop_front();
+            p->execute_release();
+        }
+    }
+
+    // if not ready yet, preroll will be executed after opening
+    if ( pipeline_ != nullptr )
+        execute_preroll();
+}
+
+void MediaPlayer::execute_preroll()
+{
+    // started playing before opening : leave pool of prerolled players
+    if ( desired_state_ == GST_STATE_PLAYING ) {
+        MediaPlayer::prerolled_pool_.remove(this);
+        prerolled_ = false;
+        return;
+    }
+
+    // go to beginning of timeline (or resync after frames from cache)
+    execute_seek_command( timeline_.next(0) );
+
+    // upload the pre-roll frame in update(), even if disabled
+    preroll_pending_ = seeking_;
+}
+
+void MediaPlayer::execute_release()
+{
+    // only a paused pipeline can be released
+    if ( pipeline_ == nullptr || released_ || !media_.seekable
+         || desired_state_ == GST_STATE_PLAYING || leader_ != nullptr )
+        return;
+
+    // keep the frame displayed, but free decoder and buffers
+    if ( gst_element_set_state (pipeline_, GST_STATE_READY) == GST_STATE_CHANGE_FAILURE )
+        return;
+    released_ = true;
+    seeking_ = false;
+
+    // pipeline is not where the frame displayed is: seek there when needed
+    cache_resync_ = true;
+
+#ifdef MEDIA_PLAYER_DEBUG
+    Log::Info("MediaPlayer %s Released decoder", std::to_string(id_).c_str());
+#endif
+}
+
+#define DECODE_MIN_HEIGHT 180
+
+void MediaPlayer::execute_decode_scale()
+{
+    // images are decoded once, at full resolution
+    if (media_.isimage) {
+        decode_height_ = media_.height;
+        return;
+    }
+
+    // height of decoded frames (full resolution by default)
+    guint h = media_.height;
+    if (decode_limit_ > DECODE_FULL)
+        h = MIN( (guint) decode_limit_, media_.height );
+    // automatic : halve resolution while larger than displayed
+    else if (decode_limit_ == DECODE_AUTO && display_height_ > 0) {
+        while ( h / 2 >= DECODE_MIN_HEIGHT ) {
+            // margin before going below current resolution (avoid toggling)
+            guint need = (h / 2 < decode_height_) ? display_height_ + display_height_ / 4 : display_height_;
+            if ( h / 2 < need )
+                break;
+            h /= 2;
+        }
+    }
+
+    // even size for scaled frames
+    if ( h < media_.height )
+        h += h % 2;
+
+    if ( h == decode_height_ || pipeline_ == nullptr )
+        return;
+
+    GstElement *scale = gst_bin_get_by_name (GST_BIN (pipeline_), "scale");
+    if (scale) {
+        // set caps of the scaler : any caps means no scaling
+        GstCaps *caps = NULL;
+        if ( h < media_.height ) {
+            guint w = (media_.width * h) / media_.height;
+            w += w % 2;
+            caps = gst_caps_new_simple ("video/x-raw", "width", G_TYPE_INT, (gint) w,
+                                        "height", G_TYPE_INT, (gint) h, NULL);
+        }
+        else
+            caps = gst_caps_new_any ();
+        // NB: capsfilter asks upstream to re-negotiate
+        g_object_set (G_OBJECT (scale), "caps", caps, NULL);
+        gst_caps_unref (caps);
+        gst_object_unref (scale);
+        // frames of the previous size in cache are obsolete
+        FrameCache::manager().remove(id_);
+#ifdef MEDIA_PLAYER_DEBUG
+        Log::Info("MediaPlayer %s Decoding at %d lines", std::to_string(id_).c_str(), h);
+#endif
+    }
+
+    decode_height_ = h;
+}
+
+bool MediaPlayer::lockstep(const MediaPlayer *p) const
+{
+    // the leader decodes the same file, playing, with the same parameters
+    // (in the same direction, unless following it in a bidirectional loop)
+    const bool direction = p->rate_ == rate_ ||
+            ( leader_ == p && loop_ == LOOP_BIDIRECTIONAL && ABS(p->rate_) == ABS(rate_) );
+    return p != this && p->leader_ == nullptr && p->opened_ && !p->failed_ && p->enabled_
+            && !media_.isimage && p->uri_.compare(uri_) == 0
+            && p->desired_state_ == GST_STATE_PLAYING && desired_state_ == GST_STATE_PLAYING
+            && direction && p->loop_ == loop_
+            && p->decode_height_ == decode_height_
+            && p->timeline_.begin() == timeline_.begin() && p->timeline_.end() == timeline_.end()
+            && p->timeline_.gaps() == timeline_.gaps();
+}
+
+void MediaPlayer::follow(MediaPlayer *leader)
+{
+    leader_ = leader;
+
+    // no need to decode
+    if (pipeline_ != nullptr)
+        gst_element_set_state (pipeline_, GST_STATE_PAUSED);
+
+#ifdef MEDIA_PLAYER_DEBUG
+    Log::Info("MediaPlayer %s Shares decoder of MediaPlayer %s", std::to_string(id_).c_str(),
+              std::to_string(leader_->id_).c_str());
+#endif
+}
+
+void MediaPlayer::unfollow()
+{
+    if (leader_ == nullptr)
+        return;
+
+    leader_ = nullptr;
+    frame_time_ = g_get_monotonic_time();
+
+    // resume decoding at the position displayed
+    if (pipeline_ != nullptr) {
+        cache_resync_ = true;
+        execute_seek_command();
+        if (enabled_)
+            gst_element_set_state (pipeline_, desired_state_);
+    }
+
+#ifdef MEDIA_PLAYER_DEBUG
+    Log::Info("MediaPlayer %s Stops sharing decoder", std::to_string(id_).c_str());
+#endif
+}
+
+void MediaPlayer::unshare()
+{
+    // use own decoder
+    unfollow();
+
+    // followers use their own decoder
+    for (auto p = registered_.begin(); p != registered_.end(); ++p) {
+        if ( (*p)->leader_ == this )
+            (*p)->unfollow();
+    }
+}
+
 bool MediaPlayer::isPlaying(bool testpipeline) const
 {
     // image cannot play
@@ -688,7 +1382,8 @@ bool MediaPlayer::isPlaying(bool testpipeline) const
         return false;
 
     // if not ready yet, answer with requested state
-    if ( !testpipeline || pipeline_ == nullptr || !enabled_)
+    // (pipeline of a follower is paused)
+    if ( !testpipeline || pipeline_ == nullptr || !enabled_ || leader_ != nullptr)
         return desired_state_ == GST_STATE_PLAYING;
 
     // if ready, answer with actual state
@@ -715,6 +1410,14 @@ void MediaPlayer::rewind(bool force)
     if (!enabled_ || !media_.seekable || pending_)
         return;
 
+    // stop sharing decoder
+    unshare();
+
+    execute_rewind(force);
+}
+
+void MediaPlayer::execute_rewind(bool force)
+{
     // playing forward, loop to begin;
     //          begin is the end of a gab which includes the first PTS (if exists)
     //          normal case, begin is zero
@@ -748,22 +1451,41 @@ void MediaPlayer::step(uint milisecond)
     if (!enabled_ || isPlaying() || pending_)
         return;
 
+    // stop sharing decoder
+    unshare();
+
     if ( ( rate_ < 0.0 && position_ <= timeline_.next(0)  )
          || ( rate_ > 0.0 && position_ >= timeline_.previous(timeline_.last()) ) )
         rewind();
     else {
-        // step event
+        // step duration
         if (milisecond < media_.dt)
             milisecond = media_.dt;
-        GstEvent *stepevent = gst_event_new_step (GST_FORMAT_TIME, milisecond, ABS(rate_), TRUE,  FALSE);
+        // step target in play direction
+        GstClockTime target = position_ + milisecond;
+        if (rate_ < 0.0)
+            target = position_ > milisecond ? position_ - milisecond : 0;
+
+        std::function<void()> steplater;
+        // target frame is in cache: display it without decoding
+        if ( FrameCache::manager().contains(id_, target) )
+            steplater = std::bind([](MediaPlayer *p, GstClockTime t) {
+                    p->cache_target_ = t; p->pending_=false; }, this, target);
+        // pipeline is not where frames from cache stopped: seek to target
+        else if ( cache_resync_ )
+            steplater = std::bind([](MediaPlayer *p, GstClockTime t) {
+                    p->execute_seek_command(t); p->pending_=false; }, this, target);
+        // step event
+        else {
+            GstEvent *stepevent = gst_event_new_step (GST_FORMAT_TIME, milisecond, ABS(rate_), TRUE,  FALSE);
+            steplater = std::bind([](MediaPlayer *p, GstEvent *e) {
+                    gst_element_send_event(p->pipeline_, e); p->pending_=false; }, this, stepevent) ;
+        }
 
         // Metronome
         if (metro_sync_) {
             // busy with this delayed action
             pending_ = true;
-            // delayed execution function
-             std::function<void()> steplater = std::bind([](MediaPlayer *p, GstEvent *e) {
-                     gst_element_send_event(p->pipeline_, e); p->pending_=false; }, this, stepevent) ;
             // Execute: sync to Metronome
             if (metro_sync_ > Metronome::SYNC_BEAT)
                 Metronome::manager().executeAtPhase( steplater );
@@ -772,7 +1494,7 @@ void MediaPlayer::step(uint milisecond)
         }
         else
             // execute immediately
-            gst_element_send_event (pipeline_, stepevent);
+            steplater();
 
     }
 }
@@ -806,8 +1528,18 @@ void MediaPlayer::seek(GstClockTime pos)
     if (!enabled_ || !media_.seekable || seeking_)
         return;
 
-    // apply seek
+    // stop sharing decoder
+    unshare();
+
     GstClockTime target = CLAMP(pos, timeline_.begin(), timeline_.end());
+
+    // paused on a frame in cache: display it without decoding
+    if ( !isPlaying() && FrameCache::manager().contains(id_, target) ) {
+        cache_target_ = target;
+        return;
+    }
+
+    // apply seek
     execute_seek_command(target);
 
 }
@@ -817,30 +1549,161 @@ void MediaPlayer::jump(uint milisecond)
     if (!enabled_ || !isPlaying())
         return;
 
+    // stop sharing decoder
+    unshare();
+
+    GstClockTime duration = CLAMP(milisecond, 1, 1000) * GST_MSECOND;
+
+    // playing backward from cache: jump in cache
+    if (cache_playback_) {
+        cache_clock_ = cache_clock_ > duration ? cache_clock_ - duration : 0;
+        return;
+    }
+
+    // display target frame from cache immediately (decoding catches up)
+    GstClockTime target = position_ + duration;
+    if (rate_ < 0.0)
+        target = position_ > duration ? position_ - duration : 0;
+    if ( FrameCache::manager().contains(id_, target) )
+        cache_target_ = target;
+
     gst_element_send_event (pipeline_, gst_event_new_step (GST_FORMAT_TIME,
-                                                           CLAMP(milisecond, 1, 1000) * GST_MSECOND,
+                                                           duration,
                                                            ABS(rate_),
                                                            TRUE,  FALSE));
 
 }
 
-void MediaPlayer::init_texture(guint index)
+// OpenGL texture format of a plane of YUV frame
+struct PlaneFormat {
+    GLenum internal;
+    GLenum format;
+    GLenum type;
+    guint pixelsize;
+};
+
+PlaneFormat yuv_plane_format(GstVideoFormat f, guint plane)
+{
+    // semi-planar formats have one plane for Y and one for interleaved UV
+    bool interleaved = plane > 0 && ( f == GST_VIDEO_FORMAT_NV12 || f == GST_VIDEO_FORMAT_P010_10LE );
+    // 10 bits formats are stored in 16 bits
+    bool deep = f == GST_VIDEO_FORMAT_P010_10LE;
+
+    PlaneFormat pf;
+    pf.format = interleaved ? GL_RG : GL_RED;
+    pf.type = deep ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+    pf.internal = interleaved ? (deep ? GL_RG16 : GL_RG8) : (deep ? GL_R16 : GL_R8);
+    pf.pixelsize = (interleaved ? 2 : 1) * (deep ? 2 : 1);
+    return pf;
+}
+
+// Matrix converting normalized YUV to RGB, following colorimetry of the frame
+glm::mat4 yuv_to_rgb_matrix(const GstVideoInfo *info)
+{
+    // get luma coefficients of color matrix (default to BT.601)
+    gdouble Kr = 0.299, Kb = 0.114;
+    if ( !gst_video_color_matrix_get_Kr_Kb(info->colorimetry.matrix, &Kr, &Kb) ) {
+        Kr = 0.299;
+        Kb = 0.114;
+    }
+    const float kr = (float) Kr;
+    const float kb = (float) Kb;
+    const float kg = 1.f - kr - kb;
+
+    // scale and offset to full range
+    const bool full = info->colorimetry.range == GST_VIDEO_COLOR_RANGE_0_255;
+    const float ys = full ? 1.f : 255.f / 219.f;
+    const float yo = full ? 0.f : 16.f / 255.f;
+    const float cs = full ? 1.f : 255.f / 224.f;
+    const float co = 128.f / 255.f;
+    glm::mat4 range = glm::mat4( ys, 0.f, 0.f, 0.f,
+                                 0.f, cs, 0.f, 0.f,
+                                 0.f, 0.f, cs, 0.f,
+                                 -yo * ys, -co * cs, -co * cs, 1.f );
+
+    // YCbCr to RGB (column major)
+    glm::mat4 rgb = glm::mat4( 1.f, 1.f, 1.f, 0.f,
+                               0.f, -2.f * kb * (1.f - kb) / kg, 2.f - 2.f * kb, 0.f,
+                               2.f - 2.f * kr, -2.f * kr * (1.f - kr) / kg, 0.f, 0.f,
+                               0.f, 0.f, 0.f, 1.f );
+
+    return rgb * range;
+}
+
+void MediaPlayer::init_texture_yuv(GstVideoFrame *f)
+{
+    GstVideoFormat format = GST_VIDEO_FRAME_FORMAT(f);
+
+    // one texture per plane
+    yuv_planes_ = MIN( GST_VIDEO_FRAME_N_PLANES(f), 3);
+    glGenTextures(yuv_planes_, yuv_textures_);
+
+    // the picture buffer will contain all planes
+    pbo_size_ = 0;
+    for (guint p = 0; p < yuv_planes_; ++p) {
+        PlaneFormat pf = yuv_plane_format(format, p);
+        glBindTexture(GL_TEXTURE_2D, yuv_textures_[p]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, pf.internal, GST_VIDEO_FRAME_COMP_WIDTH(f, p), GST_VIDEO_FRAME_COMP_HEIGHT(f, p));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        // offset of plane in picture buffer
+        yuv_offset_[p] = pbo_size_;
+        pbo_size_ += GST_VIDEO_FRAME_PLANE_STRIDE(f, p) * GST_VIDEO_FRAME_COMP_HEIGHT(f, p);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // shader converting planes to RGB
+    yuv_shader_ = new YuvShader;
+    yuv_shader_->planes = yuv_planes_;
+    yuv_shader_->chroma_texture[0] = yuv_textures_[1];
+    yuv_shader_->chroma_texture[1] = yuv_planes_ > 2 ? yuv_textures_[2] : yuv_textures_[1];
+    yuv_shader_->yuvtorgb = yuv_to_rgb_matrix( &f->info );
+    yuv_surface_ = new Surface(yuv_shader_);
+    yuv_surface_->setTextureIndex( yuv_textures_[0] );
+    yuv_surface_->setMirrorTexture( false );
+
+    // frame buffer receiving the RGB conversion, at full resolution
+    // NB: kept when decode resolution changes (texture index unchanged)
+    if (yuv_buffer_ == nullptr)
+        yuv_buffer_ = new FrameBuffer(media_.width, media_.height);
+
+    Log::Info("MediaPlayer %s Uploads %s frames in %d planes.", std::to_string(id_).c_str(),
+              gst_video_format_to_string(format), yuv_planes_);
+}
+
+void MediaPlayer::init_texture(GstVideoFrame *frame)
 {
     glActiveTexture(GL_TEXTURE0);
-    glGenTextures(1, &textureindex_);
-    glBindTexture(GL_TEXTURE_2D, textureindex_);
-    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, media_.width, media_.height);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, media_.width, media_.height,
-                    GL_RGBA, GL_UNSIGNED_BYTE, frame_[index].vframe.data[0]);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    if (!media_.isimage) {
+    // YUV frames are uploaded in planes
+    if (yuv_upload_ && GST_VIDEO_INFO_IS_YUV(&frame->info)) {
+        init_texture_yuv(frame);
+    }
+    // RGBA frames are uploaded into one texture
+    else {
+        glGenTextures(1, &textureindex_);
+        glBindTexture(GL_TEXTURE_2D, textureindex_);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, GST_VIDEO_FRAME_WIDTH(frame), GST_VIDEO_FRAME_HEIGHT(frame));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
 
         // set pbo image size
-        pbo_size_ = media_.height * media_.width * 4;
+        pbo_size_ = GST_VIDEO_FRAME_HEIGHT(frame) * GST_VIDEO_FRAME_WIDTH(frame) * 4;
+    }
+
+    // textures are sized for these frames
+    frame_width_  = GST_VIDEO_FRAME_WIDTH(frame);
+    frame_height_ = GST_VIDEO_FRAME_HEIGHT(frame);
+
+    // fill texture with first frame
+    upload_texture(frame, false);
+
+    if (!media_.isimage) {
 
         // create pixel buffer objects,
         if (pbo_[0])
@@ -856,7 +1719,7 @@ void MediaPlayer::init_texture(guint index)
             GLubyte* ptr = (GLubyte*) glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
             if (ptr)  {
                 // update data directly on the mapped buffer
-                memmove(ptr, frame_[index].vframe.data[0], pbo_size_);
+                copy_to_buffer(frame, ptr);
                 // release pointer to mapping buffer
                 glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
             }
@@ -878,22 +1741,94 @@ void MediaPlayer::init_texture(guint index)
         // initialize decoderName once
         Log::Info("MediaPlayer %s Uses %s decoding and OpenGL PBO texturing.", std::to_string(id_).c_str(), decoderName().c_str());
     }
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+void MediaPlayer::copy_to_buffer(GstVideoFrame *f, guint8 *ptr)
+{
+    // copy each plane at its offset in buffer
+    if (yuv_planes_ > 0) {
+        for (guint p = 0; p < yuv_planes_; ++p)
+            memmove(ptr + yuv_offset_[p], GST_VIDEO_FRAME_PLANE_DATA(f, p),
+                    GST_VIDEO_FRAME_PLANE_STRIDE(f, p) * GST_VIDEO_FRAME_COMP_HEIGHT(f, p));
+    }
+    // copy RGBA frame
+    else
+        memmove(ptr, f->data[0], pbo_size_);
 }
 
+void MediaPlayer::upload_texture(GstVideoFrame *f, bool from_pbo)
+{
+    // YUV frame: fill texture of each plane and convert to RGB
+    if (yuv_planes_ > 0) {
+        GstVideoFormat format = GST_VIDEO_FRAME_FORMAT(f);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (guint p = 0; p < yuv_planes_; ++p) {
+            PlaneFormat pf = yuv_plane_format(format, p);
+            glBindTexture(GL_TEXTURE_2D, yuv_textures_[p]);
+            // plane rows can be padded
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, GST_VIDEO_FRAME_PLANE_STRIDE(f, p) / pf.pixelsize);
+            // read from offset in binded PBO, or from frame data
+            const void *data = from_pbo ? (const void *) (uintptr_t) yuv_offset_[p] : GST_VIDEO_FRAME_PLANE_DATA(f, p);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GST_VIDEO_FRAME_COMP_WIDTH(f, p), GST_VIDEO_FRAME_COMP_HEIGHT(f, p),
+                            pf.format, pf.type, data);
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
 
-void MediaPlayer::fill_texture(guint index)
+        // render planes into RGB frame buffer
+        yuv_buffer_->begin(false);
+        yuv_surface_->draw(glm::identity<glm::mat4>(), yuv_buffer_->projection());
+        yuv_buffer_->end();
+    }
+    // RGBA frame: fill texture
+    else {
+        glBindTexture(GL_TEXTURE_2D, textureindex_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GST_VIDEO_FRAME_WIDTH(f), GST_VIDEO_FRAME_HEIGHT(f), GL_RGBA, GL_UNSIGNED_BYTE,
+                        from_pbo ? 0 : f->data[0]);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
+void MediaPlayer::release_texture()
+{
+    if (textureindex_)
+        glDeleteTextures(1, &textureindex_);
+    textureindex_ = 0;
+
+    if (pbo_[0])
+        glDeleteBuffers(2, pbo_);
+    pbo_[0] = pbo_[1] = 0;
+    pbo_size_ = 0;
+
+    if (yuv_planes_ > 0)
+        glDeleteTextures(yuv_planes_, yuv_textures_);
+    yuv_planes_ = 0;
+    if (yuv_surface_)
+        delete yuv_surface_; // deletes yuv_shader_
+    yuv_surface_ = nullptr;
+    yuv_shader_ = nullptr;
+
+    frame_width_ = frame_height_ = 0;
+}
+
+void MediaPlayer::fill_texture(GstVideoFrame *frame)
 {
+    // size of frames changed (decode resolution) : re-create textures
+    if ( (textureindex_ > 0 || yuv_planes_ > 0) &&
+         ( GST_VIDEO_FRAME_WIDTH(frame) != frame_width_ || GST_VIDEO_FRAME_HEIGHT(frame) != frame_height_ ) )
+        release_texture();
+
+    // new content in texture
+    ++frame_count_;
+
     // is this the first frame ?
-    if (textureindex_ < 1)
+    if (textureindex_ < 1 && yuv_planes_ < 1)
     {
         // initialize texture
-        init_texture(index);
+        init_texture(frame);
     }
     else {
-        glBindTexture(GL_TEXTURE_2D, textureindex_);
-
         // use dual Pixel Buffer Object
         if (pbo_size_ > 0) {
             // In dual PBO mode, increment current index first then get the next index
@@ -903,12 +1838,16 @@ void MediaPlayer::fill_texture(guint index)
             // bind PBO to read pixels
             glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[pbo_index_]);
             // copy pixels from PBO to texture object
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, media_.width, media_.height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+            upload_texture(frame, true);
             // bind the next PBO to write pixels
             glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[pbo_next_index_]);
 #ifdef USE_GL_BUFFER_SUBDATA
-            glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, pbo_size_, frame_[index].vframe.data[0]);
-#else
+            if (yuv_planes_ < 1) {
+                glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, pbo_size_, frame->data[0]);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                return;
+            }
+#endif
             // update data directly on the mapped buffer
             // NB : equivalent but faster than glBufferSubData (memmove instead of memcpy ?)
             // See http://www.songho.ca/opengl/gl_pbo.html#map for more details
@@ -916,23 +1855,88 @@ void MediaPlayer::fill_texture(guint index)
             // map the buffer object into client's memory
             GLubyte* ptr = (GLubyte*) glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
             if (ptr) {
-                memmove(ptr, frame_[index].vframe.data[0], pbo_size_);
+                copy_to_buffer(frame, ptr);
                 // release pointer to mapping buffer
                 glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
             }
-#endif
             // done with PBO
             glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
         }
         else {
             // without PBO, use standard opengl (slower)
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, media_.width, media_.height,
-                            GL_RGBA, GL_UNSIGNED_BYTE, frame_[index].vframe.data[0]);
+            upload_texture(frame, false);
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
     }
 }
 
+bool MediaPlayer::display_cached(GstClockTime target)
+{
+    GstVideoInfo info;
+    GstBuffer *buf = FrameCache::manager().get(id_, target, &info);
+    if (buf == nullptr)
+        return false;
+
+    bool ret = true;
+
+    // do not fill the same frame twice
+    if (buf->pts != position_) {
+        GstVideoFrame vframe;
+        if ( gst_video_frame_map (&vframe, &info, buf, GST_MAP_READ ) ) {
+            fill_texture(&vframe);
+            // double update for dual PBO (ensure frame is displayed now)
+            if (pbo_size_ > 0)
+                fill_texture(&vframe);
+            gst_video_frame_unmap(&vframe);
+            // we just displayed a vframe : set position time to frame PTS
+            position_ = buf->pts;
+        }
+        else
+            ret = false;
+    }
+
+    gst_buffer_unref(buf);
+    return ret;
+}
+
+bool MediaPlayer::update_reverse_cached()
+{
+    if ( !FrameCache::manager().enabled() || !media_.seekable || position_ == GST_CLOCK_TIME_NONE )
+        return false;
+
+    const gint64 now = g_get_monotonic_time();
+
+    // start when previous frame is in cache
+    if (!cache_playback_) {
+        if ( position_ < media_.dt || !FrameCache::manager().contains(id_, position_ - media_.dt) )
+            return false;
+        // pause decoding, the cache takes over
+        gst_element_set_state (pipeline_, GST_STATE_PAUSED);
+        cache_playback_ = true;
+        cache_clock_ = position_;
+        cache_time_ = now;
+#ifdef MEDIA_PLAYER_DEBUG
+        Log::Info("MediaPlayer %s Play backward from cache", std::to_string(id_).c_str());
+#endif
+    }
+
+    // move clock backward at play speed
+    GstClockTime delta = static_cast<GstClockTime>( static_cast<double>(now - cache_time_) * GST_USECOND * ABS(rate_) );
+    cache_clock_ = cache_clock_ > delta ? cache_clock_ - delta : 0;
+    cache_time_ = now;
+
+    // reached beginning: should loop
+    if ( cache_clock_ <= timeline_.next(0) )
+        return true;
+
+    // frame not in cache: decoding resumes at current position
+    if ( !display_cached(cache_clock_) )
+        execute_seek_command();
+
+    return false;
+}
+
+#define FRAME_CACHE_HISTORY (2 * GST_SECOND)
+
 void MediaPlayer::update()
 {
     // discard
@@ -964,55 +1968,111 @@ void MediaPlayer::update()
     }
 
     // prevent unnecessary updates: disabled or already filled image
-    if ( (!enabled_ && !force_update_) || (media_.isimage && textureindex_>0 ) )
+    if ( (!enabled_ && !force_update_ && !preroll_pending_) || (media_.isimage && textureindex_>0 ) )
         return;
 
+    // apply change of decode resolution
+    if (!media_.isimage)
+        execute_decode_scale();
+
+    // keep decoded frames for stepping, scrubbing and reverse play, but
+    // only a short history behind the position during normal playback
+    cache_fill_ = !media_.isimage;
+    if ( desired_state_ != GST_STATE_PLAYING || rate_ < 0.0 || seeking_ )
+        cache_history_ = GST_CLOCK_TIME_NONE;
+    else
+        cache_history_ = FRAME_CACHE_HISTORY;
+
+    // display frames decoded by the leader while in lockstep
+    if (leader_ != nullptr) {
+        if ( lockstep(leader_) ) {
+            position_ = leader_->position_;
+            // (bidirectional loop)
+            rate_ = leader_->rate_;
+            force_update_ = false;
+            return;
+        }
+        unfollow();
+    }
+    // share decoder of a player in lockstep
+    else if ( desired_state_ == GST_STATE_PLAYING && position_ != GST_CLOCK_TIME_NONE
+              && !seeking_ && !pending_ && !cache_playback_ && cache_target_ == GST_CLOCK_TIME_NONE ) {
+        for (auto p = registered_.begin(); p != registered_.end(); ++p) {
+            if ( (*p)->id_ < id_ && lockstep(*p) && (*p)->position_ != GST_CLOCK_TIME_NONE &&
+                 ABS_DIFF(position_, (*p)->position_) < timeline_.step() / 2 ) {
+                follow(*p);
+                return;
+            }
+        }
+    }
+
     // local variables before trying to update
-    guint read_index = 0;
     bool need_loop = false;
+    bool displayed = false;
 
-    // locked access to current index
-    index_lock_.lock();
-    // get the last frame filled from fill_frame()
-    read_index = last_index_;
-    // unlock access to index change
-    index_lock_.unlock();
-
-    // lock frame while reading it
-    frame_[read_index].access.lock();
+    // get the last frame filled from fill_frame() (never blocks)
+    FrameQueue *queue = frame_queue_.load();
+    FrameQueue::Frame *frame = queue->readFrame();
 
+    // ignore decoded frames while playing from cache
+    if (frame != nullptr && cache_playback_) {
+        queue->pop();
+    }
     // do not fill a frame twice
-    if (frame_[read_index].status != INVALID ) {
+    else if (frame != nullptr) {
 
         // is this an End-of-Stream frame ?
-        if (frame_[read_index].status == EOS )
+        if (frame->status == FrameQueue::EOS )
         {
-            // will execute seek command below (after unlock)
+            // will execute seek command below (after release)
             need_loop = true;
         }
         // otherwise just fill non-empty SAMPLE or PREROLL
-        else if (frame_[read_index].full)
+        else if (frame->full)
         {
-            // fill the texture with the frame at reading index
-            fill_texture(read_index);
+            // fill the texture with the frame read
+            fill_texture(&frame->vframe);
+            displayed = true;
 
             // double update for pre-roll frame and dual PBO (ensure frame is displayed now)
-            if ( (frame_[read_index].status == PREROLL || seeking_ ) && pbo_size_ > 0)
-                fill_texture(read_index);
+            if ( (frame->status == FrameQueue::PREROLL || seeking_ ) && pbo_size_ > 0)
+                fill_texture(&frame->vframe);
 
-            // free frame
-            frame_[read_index].unmap();
+            // requested preroll is done
+            if (frame->status == FrameQueue::PREROLL)
+                preroll_pending_ = false;
         }
 
         // we just displayed a vframe : set position time to frame PTS
-        position_ = frame_[read_index].position;
+        position_ = frame->position;
+
+        // free frame and give it back to fill_frame()
+        queue->pop();
+    }
 
-        // avoid reading it again
-        frame_[read_index].status = INVALID;
+    // a frame from cache was requested (step, seek, jump)
+    if (cache_target_ != GST_CLOCK_TIME_NONE) {
+        // when paused, pipeline is not at the position displayed
+        if ( display_cached(cache_target_) && desired_state_ != GST_STATE_PLAYING )
+            cache_resync_ = true;
+        cache_target_ = GST_CLOCK_TIME_NONE;
     }
+    // play backward from frames in cache
+    else if ( rate_ < 0.0 && desired_state_ == GST_STATE_PLAYING && !seeking_ && update_reverse_cached() )
+        need_loop = true;
+
+    // errors and end of segments
+    execute_bus_messages(true);
 
-    // unkock frame after reading it
-    frame_[read_index].access.unlock();
+    // monitor decoding : fall back to software if hardware decoder fails
+    if ( !media_.isimage && probe_hardware_decoding(displayed) )
+        return;
+
+    // resume at position before re-openning
+    if ( displayed && resume_position_ != GST_CLOCK_TIME_NONE ) {
+        execute_seek_command(resume_position_);
+        resume_position_ = GST_CLOCK_TIME_NONE;
+    }
 
     // if already seeking (asynch)
     if (seeking_) {
@@ -1037,8 +2097,8 @@ void MediaPlayer::update()
                     jumpPts *= ( gap.begin / timeline_.step() );   // BWD: go to begin of gap
                 // (if not beginnig or end of timeline)
                 if (jumpPts > timeline_.first() && jumpPts < timeline_.last())
-                    // seek to jump PTS time
-                    seek( jumpPts );
+                    // seek to jump PTS time (followers jump with the leader)
+                    execute_seek_command( jumpPts );
                 // otherwise, we should loop
                 else
                     need_loop = true;
@@ -1056,7 +2116,9 @@ void MediaPlayer::update()
 void MediaPlayer::execute_loop_command()
 {
     if (loop_==LOOP_REWIND) {
-        rewind();
+        // NB: followers loop with the leader
+        if (enabled_ && media_.seekable && !pending_)
+            execute_rewind(false);
     }
     else if (loop_==LOOP_BIDIRECTIONAL) {
         rate_ *= - 1.f;
@@ -1073,6 +2135,19 @@ void MediaPlayer::execute_seek_command(GstClockTime target, bool force)
     if ( pipeline_ == nullptr || !media_.seekable )
         return;
 
+    // released pipeline must be paused again to seek
+    if ( released_ ) {
+        released_ = false;
+        gst_element_set_state (pipeline_, GST_STATE_PAUSED);
+        gst_element_get_state (pipeline_, NULL, NULL, GST_CLOCK_TIME_NONE);
+    }
+
+    // decoding resumes where frames from cache stopped
+    const bool resume = cache_playback_;
+    const bool resync = cache_playback_ || cache_resync_;
+    cache_playback_ = false;
+    cache_resync_ = false;
+
     // seek position : default to target
     GstClockTime seek_pos = target;
 
@@ -1081,7 +2156,7 @@ void MediaPlayer::execute_seek_command(GstClockTime target, bool force)
         // create seek event with current position (rate changed ?)
         seek_pos = position_;
     // target is given but useless
-    else if ( ABS_DIFF(target, position_) < timeline_.step()) {
+    else if ( ABS_DIFF(target, position_) < timeline_.step() && !resync ) {
         // ignore request
         return;
     }
@@ -1095,15 +2170,32 @@ void MediaPlayer::execute_seek_command(GstClockTime target, bool force)
     else
         seek_flags |= GST_SEEK_FLAG_ACCURATE;
 
+    // gapless : play only the section of timeline in play direction
+    // (next section is queued when the segment is done)
+    segment_.reset();
+    if ( gapless_ && timeline_.numGaps() > 0 && timeline_.getSectionAt(seek_pos, segment_, rate_ > 0) ) {
+        seek_flags |= GST_SEEK_FLAG_SEGMENT;
+        // discard segment done of previous segments
+        execute_bus_messages(false);
+    }
+
     // create seek event depending on direction
     GstEvent *seek_event = nullptr;
     if (rate_ > 0) {
-        seek_event = gst_event_new_seek (rate_, GST_FORMAT_TIME, (GstSeekFlags) seek_flags,
-            GST_SEEK_TYPE_SET, seek_pos, GST_SEEK_TYPE_END, 0);
+        if (segment_.is_valid())
+            seek_event = gst_event_new_seek (rate_, GST_FORMAT_TIME, (GstSeekFlags) seek_flags,
+                GST_SEEK_TYPE_SET, MAX(seek_pos, segment_.begin), GST_SEEK_TYPE_SET, segment_.end);
+        else
+            seek_event = gst_event_new_seek (rate_, GST_FORMAT_TIME, (GstSeekFlags) seek_flags,
+                GST_SEEK_TYPE_SET, seek_pos, GST_SEEK_TYPE_END, 0);
     }
     else {
-        seek_event = gst_event_new_seek (rate_, GST_FORMAT_TIME, (GstSeekFlags) seek_flags,
-            GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_SET, seek_pos);
+        if (segment_.is_valid())
+            seek_event = gst_event_new_seek (rate_, GST_FORMAT_TIME, (GstSeekFlags) seek_flags,
+                GST_SEEK_TYPE_SET, segment_.begin, GST_SEEK_TYPE_SET, MIN(seek_pos, segment_.end));
+        else
+            seek_event = gst_event_new_seek (rate_, GST_FORMAT_TIME, (GstSeekFlags) seek_flags,
+                GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_SET, seek_pos);
     }
 
     // Send the event (ASYNC)
@@ -1116,6 +2208,10 @@ void MediaPlayer::execute_seek_command(GstClockTime target, bool force)
 #endif
     }
 
+    // pipeline was paused while playing from cache
+    if (resume)
+        gst_element_set_state (pipeline_, desired_state_);
+
     // Force update
     if (force) {
         gst_element_get_state (pipeline_, NULL, NULL, GST_CLOCK_TIME_NONE);
@@ -1124,6 +2220,154 @@ void MediaPlayer::execute_seek_command(GstClockTime target, bool force)
 
 }
 
+void MediaPlayer::execute_segment_done()
+{
+    const bool forward = rate_ > 0;
+
+    // next section of timeline in play direction
+    TimeInterval next;
+    bool found = timeline_.getSectionAt( forward ? segment_.end : segment_.begin, next, forward );
+
+    // end of timeline : loop without seeking to first section
+    if ( !found && loop_ == LOOP_REWIND && metro_sync_ == Metronome::SYNC_NONE )
+        found = timeline_.getSectionAt( forward ? 0 : timeline_.end(), next, forward );
+
+    // end of stream : loop as usual
+    if ( !found ) {
+        segment_.reset();
+        execute_loop_command();
+        return;
+    }
+
+    // seek without flush : data of next section follows the current one
+    int seek_flags = GST_SEEK_FLAG_SEGMENT;
+    if ( ABS(rate_) > 1.5 )
+        seek_flags |= GST_SEEK_FLAG_TRICKMODE;
+    else
+        seek_flags |= GST_SEEK_FLAG_ACCURATE;
+
+    GstEvent *seek_event = gst_event_new_seek (rate_, GST_FORMAT_TIME, (GstSeekFlags) seek_flags,
+                                               GST_SEEK_TYPE_SET, next.begin, GST_SEEK_TYPE_SET, next.end);
+    if ( !gst_element_send_event(pipeline_, seek_event) ) {
+        Log::Warning("MediaPlayer %s Segment seek failed", std::to_string(id_).c_str());
+        segment_.reset();
+        return;
+    }
+
+    segment_ = next;
+#ifdef MEDIA_PLAYER_DEBUG
+    Log::Info("MediaPlayer %s Segment [%ld %ld]", std::to_string(id_).c_str(), segment_.begin, segment_.end);
+#endif
+}
+
+void MediaPlayer::execute_bus_messages(bool segments)
+{
+    GstBus *bus = gst_element_get_bus (pipeline_);
+    GstMessage *msg = NULL;
+    while ( (msg = gst_bus_pop_filtered (bus, (GstMessageType) (GST_MESSAGE_ERROR | GST_MESSAGE_SEGMENT_DONE))) != NULL ) {
+        // error in pipeline
+        if ( GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR ) {
+            GError *err = NULL;
+            gst_message_parse_error (msg, &err, NULL);
+            Log::Warning("MediaPlayer %s Error: %s", std::to_string(id_).c_str(), err ? err->message : "unknown");
+            g_clear_error (&err);
+            // error of hardware decoder (checked by probe of hardware decoding)
+            const std::string hwdec = GstToolkit::used_gpu_decoding_plugins(pipeline_);
+            if ( !hwdec.empty() && std::string(GST_MESSAGE_SRC_NAME (msg)).find(hwdec) != std::string::npos )
+                decoding_error_ = true;
+        }
+        // gapless : queue next section when the current segment is done
+        else if ( segments && segment_.is_valid() ) {
+            gint64 pos = GST_CLOCK_TIME_NONE;
+            gst_message_parse_segment_done (msg, NULL, &pos);
+            // ignore segment done of previous segments
+            if ( ABS_DIFF( (GstClockTime) pos, rate_ > 0 ? segment_.end : segment_.begin ) < timeline_.step() )
+                execute_segment_done();
+        }
+        gst_message_unref (msg);
+    }
+    gst_object_unref (bus);
+}
+
+std::string MediaPlayer::decoder_key() const
+{
+    // codec (and profile) at standard resolution
+    static const guint heights[4] = { 576, 720, 1080, 2160 };
+    guint h = 4320;
+    for (int i = 0; i < 4; ++i) {
+        if (media_.height <= heights[i]) {
+            h = heights[i];
+            break;
+        }
+    }
+    return media_.codec_name + " " + std::to_string(h) + "p";
+}
+
+#define HW_PROBE_TIMEOUT  (5 * G_USEC_PER_SEC)
+#define HW_PROBE_DURATION (30 * GST_SECOND)
+#define HW_PROBE_STALLS   3
+
+bool MediaPlayer::probe_hardware_decoding(bool displayed)
+{
+    const gint64 now = g_get_monotonic_time();
+
+    // no frame expected when paused, following another player or playing from cache
+    // (except the first frame)
+    const bool expecting = position_ == GST_CLOCK_TIME_NONE ||
+            ( desired_state_ == GST_STATE_PLAYING && !seeking_ && !pending_ && !cache_playback_ && leader_ == nullptr );
+    if ( displayed || !expecting ) {
+        frame_time_ = now;
+        if ( displayed )
+            hw_stalls_ = 0;
+    }
+
+    // enough frames decoded : remember that hardware decoding works for this codec
+    if ( displayed && hw_frames_ != G_MAXUINT64 && media_.dt != GST_CLOCK_TIME_NONE ) {
+        if ( ++hw_frames_ * media_.dt > HW_PROBE_DURATION ) {
+            hw_frames_ = G_MAXUINT64;
+            if ( !force_software_decoding_ && !hw_fallback_ && Settings::application.render.gpu_decoding
+                 && !GstToolkit::used_gpu_decoding_plugins(pipeline_).empty() )
+                HardwareDecoderCache::instance().set(decoder_key(), true);
+        }
+    }
+
+    // no error, and frames are not late (at most 4 frames at play speed)
+    gint64 timeout = HW_PROBE_TIMEOUT;
+    if ( media_.dt != GST_CLOCK_TIME_NONE )
+        timeout = MAX( timeout, (gint64) (4.0 * (double) GST_TIME_AS_USECONDS(media_.dt) / ABS(rate_)) );
+    if ( !decoding_error_ && now - frame_time_ < timeout )
+        return false;
+
+    // report once
+    const bool error = decoding_error_;
+    decoding_error_ = false;
+    frame_time_ = now;
+
+    // nothing to do if not decoding with hardware
+    if ( force_software_decoding_ || hw_fallback_ || !Settings::application.render.gpu_decoding )
+        return false;
+    const std::string hwdec = GstToolkit::used_gpu_decoding_plugins(pipeline_);
+    if ( hwdec.empty() )
+        return false;
+
+    // a stall can come from a slow, remote or suspended source: wait for it to repeat
+    if ( !error && ++hw_stalls_ < HW_PROBE_STALLS )
+        return false;
+
+    // remember error of decoder (stalls only for this player) and re-open with software decoding
+    Log::Warning("MediaPlayer %s Hardware decoder %s %s with %s; switching to software decoding.",
+                 std::to_string(id_).c_str(), hwdec.c_str(), error ? "failed" : "stalled", decoder_key().c_str());
+    if ( error )
+        HardwareDecoderCache::instance().set(decoder_key(), false);
+    else
+        hw_stalled_ = true;
+    resume_position_ = position_;
+    decoder_name_ = "";
+    reopen();
+
+    return true;
+}
+
 void MediaPlayer::setPlaySpeed(double s)
 {
     if (media_.isimage)
@@ -1135,6 +2379,9 @@ void MediaPlayer::setPlaySpeed(double s)
     if (ABS(rate_) < MIN_PLAY_SPEED)
         rate_ = SIGN(rate_) * MIN_PLAY_SPEED;
 
+    // stop sharing decoder
+    unshare();
+
     // apply with seek
     execute_seek_command();
 }
@@ -1192,80 +2439,76 @@ double MediaPlayer::updateFrameRate() const
 
 // CALLBACKS
 
-bool MediaPlayer::fill_frame(GstBuffer *buf, FrameStatus status)
+bool MediaPlayer::fill_frame(GstBuffer *buf, FrameQueue::FrameStatus status)
 {
-    // Do NOT overwrite an unread EOS
-    if ( frame_[write_index_].status == EOS )
-        write_index_ = (write_index_ + 1) % N_VFRAME;
+    // frames of the pipeline being closed are not published
+    FrameQueue *queue = frame_queue_.load();
+    if (!opened_)
+        return true;
+
+    // null buffer for EOS: give a position
+    if (buf == NULL) {
+        queue->pushEndOfStream( rate_ > 0.0 ? timeline_.end() : timeline_.begin() );
+        return true;
+    }
 
-    // lock access to frame
-    frame_[write_index_].access.lock();
+    // get a free frame to write (no lock)
+    FrameQueue::Frame *frame = queue->writeFrame(status);
 
-    // always empty frame before filling it again
-    frame_[write_index_].unmap();
+    // all frames are still to be displayed: drop this one
+    if (frame == nullptr) {
+#ifdef MEDIA_PLAYER_DEBUG
+        Log::Info("MediaPlayer %s Dropped a frame", std::to_string(id_).c_str());
+#endif
+        return true;
+    }
 
     // accept status of frame received
-    frame_[write_index_].status = status;
-
-    // a buffer is given (not EOS)
-    if (buf != NULL) {
+    frame->status = status;
 
-        // get the frame from buffer
-        if ( !gst_video_frame_map (&frame_[write_index_].vframe, &v_frame_video_info_, buf, GST_MAP_READ ) )
-        {
+    // get the frame from buffer
+    if ( !gst_video_frame_map (&frame->vframe, &v_frame_video_info_, buf, GST_MAP_READ ) )
+    {
 #ifdef MEDIA_PLAYER_DEBUG
-            Log::Info("MediaPlayer %s Failed to map the video buffer", std::to_string(id_).c_str());
+        Log::Info("MediaPlayer %s Failed to map the video buffer", std::to_string(id_).c_str());
 #endif
-            // free access to frame & exit
-            frame_[write_index_].status = INVALID;
-            frame_[write_index_].access.unlock();
-            return false;
-        }
+        // do not publish frame & exit
+        frame->status = FrameQueue::INVALID;
+        return false;
+    }
 
-        // successfully filled the frame
-        frame_[write_index_].full = true;
+    // successfully filled the frame
+    frame->full = true;
 
-        // validate frame format
-        if( GST_VIDEO_INFO_IS_RGB(&(frame_[write_index_].vframe).info) && GST_VIDEO_INFO_N_PLANES(&(frame_[write_index_].vframe).info) == 1)
-        {
-            // set presentation time stamp
-            frame_[write_index_].position = buf->pts;
+    // validate frame format (RGBA, or YUV planes if enabled)
+    if( ( GST_VIDEO_INFO_IS_RGB(&(frame->vframe).info) && GST_VIDEO_INFO_N_PLANES(&(frame->vframe).info) == 1 )
+        || ( yuv_upload_ && GST_VIDEO_INFO_IS_YUV(&(frame->vframe).info) ) )
+    {
+        // set presentation time stamp
+        frame->position = buf->pts;
 
-            // set the start position (i.e. pts of first frame we got)
-            if (timeline_.first() == GST_CLOCK_TIME_NONE) {
-                timeline_.setFirst(buf->pts);
-            }
-        }
-        // full but invalid frame : will be deleted next iteration
-        // (should never happen)
-        else {
-#ifdef MEDIA_PLAYER_DEBUG
-            Log::Info("MediaPlayer %s Received an Invalid frame", std::to_string(id_).c_str());
-#endif
-            // free access to frame & exit
-            frame_[write_index_].status = INVALID;
-            frame_[write_index_].access.unlock();
-            return false;
+        // set the start position (i.e. pts of first frame we got)
+        if (timeline_.first() == GST_CLOCK_TIME_NONE) {
+            timeline_.setFirst(buf->pts);
         }
+
+        // keep a copy for stepping, scrubbing and reverse play
+        if ( cache_fill_ )
+            FrameCache::manager().add(id_, buf, &(frame->vframe).info, media_.dt, cache_history_);
     }
-    // else; null buffer for EOS: give a position
+    // full but invalid frame : free it and do not publish
+    // (should never happen)
     else {
-        frame_[write_index_].status = EOS;
-        frame_[write_index_].position = rate_ > 0.0 ? timeline_.end() : timeline_.begin();
+#ifdef MEDIA_PLAYER_DEBUG
+        Log::Info("MediaPlayer %s Received an Invalid frame", std::to_string(id_).c_str());
+#endif
+        frame->unmap();
+        frame->status = FrameQueue::INVALID;
+        return false;
     }
 
-    // unlock access to frame
-    frame_[write_index_].access.unlock();
-
-    // lock access to change current index (very quick)
-    index_lock_.lock();
-    // indicate update() that this is the last frame filled (and unlocked)
-    last_index_ = write_index_;
-    // unlock access to index change
-    index_lock_.unlock();
-
-    // for writing, we will access the next in stack
-    write_index_ = (write_index_ + 1) % N_VFRAME;
+    // indicate update() that this is the last frame filled
+    queue->push();
 
     // calculate actual FPS of update
     timecount_.tic();
@@ -1273,11 +2516,27 @@ bool MediaPlayer::fill_frame(GstBuffer *buf, FrameStatus status)
     return true;
 }
 
+void MediaPlayer::set_video_info(GstCaps *caps)
+{
+    // parse caps only when they change (e.g. decode resolution)
+    if ( caps == NULL || caps == v_frame_caps_ ||
+         ( v_frame_caps_ != NULL && gst_caps_is_equal(caps, v_frame_caps_) ) )
+        return;
+
+    GstVideoInfo info;
+    if ( !gst_video_info_from_caps (&info, caps) )
+        return;
+
+    // NB: only used in streaming thread; frames queued or cached keep their own video info
+    v_frame_video_info_ = info;
+    gst_caps_replace (&v_frame_caps_, caps);
+}
+
 void MediaPlayer::callback_end_of_stream (GstAppSink *, gpointer p)
 {
     MediaPlayer *m = static_cast<MediaPlayer *>(p);
     if (m && m->opened_) {
-        m->fill_frame(NULL, MediaPlayer::EOS);
+        m->fill_frame(NULL, FrameQueue::EOS);
     }
 }
 
@@ -1295,15 +2554,18 @@ GstFlowReturn MediaPlayer::callback_new_preroll (GstAppSink *sink, gpointer p)
         MediaPlayer *m = static_cast<MediaPlayer *>(p);
         if (m && m->opened_) {
 
+            // format and size are negotiated: get video info from caps of preroll
+            m->set_video_info( gst_sample_get_caps (sample) );
+
             // get buffer from sample
             GstBuffer *buf = gst_sample_get_buffer (sample);
 
             // fill frame from buffer
-            if ( !m->fill_frame(buf, MediaPlayer::PREROLL) )
+            if ( !m->fill_frame(buf, FrameQueue::PREROLL) )
                 ret = GST_FLOW_ERROR;
             // loop negative rate: emulate an EOS
             else if (m->playSpeed() < 0.f && !(buf->pts > 0) ) {
-                m->fill_frame(NULL, MediaPlayer::EOS);
+                m->fill_frame(NULL, FrameQueue::EOS);
             }
         }
     }
@@ -1330,15 +2592,18 @@ GstFlowReturn MediaPlayer::callback_new_sample (GstAppSink *sink, gpointer p)
         MediaPlayer *m = static_cast<MediaPlayer *>(p);
         if (m && m->opened_) {
 
+            // size changes with decode resolution: get video info from caps of sample
+            m->set_video_info( gst_sample_get_caps (sample) );
+
             // get buffer from sample (valid until sample is released)
             GstBuffer *buf = gst_sample_get_buffer (sample) ;
 
             // fill frame with buffer
-            if ( !m->fill_frame(buf, MediaPlayer::SAMPLE) )
+            if ( !m->fill_frame(buf, FrameQueue::SAMPLE) )
                 ret = GST_FLOW_ERROR;
             // loop negative rate: emulate an EOS
             else if (m->playSpeed() < 0.f && !(buf->pts > 0) ) {
-                m->fill_frame(NULL, MediaPlayer::EOS);
+                m->fill_frame(NULL, FrameQueue::EOS);
             }
         }
     }
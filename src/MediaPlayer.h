@@ -12,14 +12,21 @@
 #include <gst/app/gstappsink.h>
 
 #include "Timeline.h"
+#include "FrameQueue.h"
 #include "Metronome.h"
 
 // Forward declare classes referenced
 class Visitor;
+class FrameBuffer;
+class Surface;
+class YuvShader;
 
 #define MAX_PLAY_SPEED 20.0
 #define MIN_PLAY_SPEED 0.1
 #define N_VFRAME 5
+#define N_PREROLL 8
+#define DECODE_FULL 0
+#define DECODE_AUTO -1
 
 struct MediaInfo {
 
@@ -171,6 +178,24 @@ public:
      * Seek to zero
      * */
     void rewind(bool force = false);
+    /**
+     * Pause on the first frame of the timeline, uploaded
+     * even if disabled, so that play(true) starts immediately.
+     * At most N_PREROLL players are kept prerolled;
+     * the oldest leaves the pool when it is full and
+     * releases its decoder (until next seek or play).
+     * Does nothing if playing.
+     * */
+    void preroll();
+    inline bool prerolled() const { return prerolled_; }
+    /**
+     * True if the player displays the frames decoded by another
+     * player of the same file, playing in lockstep (same timeline,
+     * speed and position). Its own pipeline is paused meanwhile and
+     * resumes as soon as playback diverges (any command, or change
+     * of timeline, speed, loop or decode resolution).
+     * */
+    inline bool shared() const { return leader_ != nullptr; }
     /**
      * pending
      * */
@@ -228,6 +253,11 @@ public:
      * Must be called in OpenGL context
      * */
     guint texture() const;
+    /**
+     * Get the number of frames filled in the texture
+     * (changes when the content of texture changes)
+     * */
+    uint64_t frameCount() const;
     /**
      * Get the name of the decoder used,
      * return 'software' if no hardware decoder is used
@@ -241,12 +271,41 @@ public:
      * */
     void setSoftwareDecodingForced(bool on);
     bool softwareDecodingForced();
+    /**
+     * True if frames are uploaded in their native YUV format
+     * and converted to RGB on the GPU
+     * (enabled by Settings::application.render.yuv_upload at open)
+     * */
+    inline bool yuvUpload() const { return yuv_upload_; }
+    /**
+     * Maximum height of decoded frames, scaled down in the pipeline
+     * before color conversion (DECODE_FULL or DECODE_AUTO, or a height)
+     * NB: applied without re-openning (caps are re-negotiated)
+     * */
+    inline void setDecodeLimit(int h) { decode_limit_ = h; }
+    inline int decodeLimit() const { return decode_limit_; }
+    /**
+     * Height of the media when displayed, used with DECODE_AUTO
+     * (0 if unknown, decoded at full resolution)
+     * */
+    inline void setDisplayHeight(guint h) { display_height_ = h; }
+    /**
+     * Actual height of decoded frames
+     * */
+    inline guint decodeHeight() const { return decode_height_; }
     /**
      * Option to automatically rewind each time the player is disabled
      * (i.e. when enable(false) is called )
      * */
     inline void setRewindOnDisabled(bool on) { rewind_on_disable_ = on; }
     inline bool rewindOnDisabled() const { return rewind_on_disable_; }
+    /**
+     * Option to play the sections of the timeline as a sequence of
+     * segments: the next section is queued before the end of the
+     * current one, instead of seeking when reaching a gap
+     * */
+    inline void setGapless(bool on) { gapless_ = on; }
+    inline bool gapless() const { return gapless_; }
     /**
      * Option to synchronize with metronome
      * */
@@ -274,6 +333,7 @@ private:
     std::string filename_;
     std::string uri_;
     guint textureindex_;
+    uint64_t frame_count_;
 
     // general properties of media
     MediaInfo media_;
@@ -287,6 +347,7 @@ private:
     GstState desired_state_;
     GstElement *pipeline_;
     GstVideoInfo v_frame_video_info_;
+    GstCaps *v_frame_caps_;
     std::atomic<bool> opened_;
     std::atomic<bool> failed_;
     bool force_update_;
@@ -294,7 +355,18 @@ private:
     bool seeking_;
     bool enabled_;
     bool rewind_on_disable_;
+    bool gapless_;
+    TimeInterval segment_;
     bool force_software_decoding_;
+    bool hw_fallback_;
+    bool yuv_upload_;
+    bool prerolled_;
+    bool preroll_pending_;
+    bool released_;
+    int decode_limit_;
+    MediaPlayer *leader_;
+    guint display_height_;
+    guint decode_height_;
     std::string decoder_name_;
     Metronome::Synchronicity metro_sync_;
 
@@ -311,47 +383,70 @@ private:
     TimeCounter timecount_;
 
     // frame stack
-    typedef enum  {
-        SAMPLE = 0,
-        PREROLL = 1,
-        EOS = 2,
-        INVALID = 3
-    } FrameStatus;
-
-    struct Frame {
-        GstVideoFrame vframe;
-        FrameStatus status;
-        bool full;
-        GstClockTime position;
-        std::mutex access;
-
-        Frame() {
-            full = false;
-            status = INVALID;
-            position = GST_CLOCK_TIME_NONE;
-        }
-        void unmap();
-    };
-    Frame frame_[N_VFRAME];
-    guint write_index_;
-    guint last_index_;
-    std::mutex index_lock_;
+    std::atomic<FrameQueue *> frame_queue_;
+
+    // decoded frames cache
+    GstClockTime cache_target_;
+    GstClockTime cache_clock_;
+    gint64 cache_time_;
+    bool cache_playback_;
+    bool cache_resync_;
+    std::atomic<bool> cache_fill_;
+    std::atomic<GstClockTime> cache_history_;
 
     // for PBO
     guint pbo_[2];
     guint pbo_index_, pbo_next_index_;
     guint pbo_size_;
+    guint frame_width_, frame_height_;
+
+    // for YUV planes
+    guint yuv_planes_;
+    guint yuv_textures_[3];
+    guint yuv_offset_[3];
+    FrameBuffer *yuv_buffer_;
+    Surface *yuv_surface_;
+    YuvShader *yuv_shader_;
 
     // gst pipeline control
     void execute_open();
     void execute_play_command(bool on);
     void execute_loop_command();
     void execute_seek_command(GstClockTime target = GST_CLOCK_TIME_NONE, bool force = false);
+    void execute_preroll();
+    void execute_release();
+    void execute_decode_scale();
+    void execute_rewind(bool force);
+    void execute_segment_done();
+    void execute_bus_messages(bool segments);
+
+    // hardware decoding probe
+    bool decoding_error_;
+    gint64 frame_time_;
+    guint64 hw_frames_;
+    guint hw_stalls_;
+    bool hw_stalled_;
+    GstClockTime resume_position_;
+    std::string decoder_key() const;
+    bool probe_hardware_decoding(bool displayed);
+
+    // shared decoding
+    bool lockstep(const MediaPlayer *p) const;
+    void follow(MediaPlayer *leader);
+    void unfollow();
+    void unshare();
 
     // gst frame filling
-    void init_texture(guint index);
-    void fill_texture(guint index);
-    bool fill_frame(GstBuffer *buf, FrameStatus status);
+    void init_texture(GstVideoFrame *frame);
+    void init_texture_yuv(GstVideoFrame *frame);
+    void release_texture();
+    void set_video_info(GstCaps *caps);
+    void fill_texture(GstVideoFrame *frame);
+    void upload_texture(GstVideoFrame *frame, bool from_pbo);
+    void copy_to_buffer(GstVideoFrame *frame, guint8 *ptr);
+    bool fill_frame(GstBuffer *buf, FrameQueue::FrameStatus status);
+    bool display_cached(GstClockTime target);
+    bool update_reverse_cached();
 
     // gst callbacks
     static void callback_end_of_stream (GstAppSink *, gpointer);
@@ -360,6 +455,9 @@ private:
 
     // global list of registered media player
     static std::list<MediaPlayer*> registered_;
+
+    // pool of prerolled media player
+    static std::list<MediaPlayer*> prerolled_pool_;
 };
 
 
@@ -0,0 +1,227 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <thread>
+#include <sstream>
+#include <cstdio>
+
+// GStreamer
+#include <gst/gst.h>
+
+#include "defines.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemToolkit.h"
+#include "GstToolkit.h"
+#include "MediaPlayer.h"
+#include "Recorder.h"
+
+#include "MediaProxy.h"
+
+const char* MediaProxy::codec_name[PROXY_CODEC_INVALID] = { "Motion JPEG", "Apple ProRes" };
+const int MediaProxy::resolution_height[4] = { 360, 540, 720, 1080 };
+const char* MediaProxy::resolution_name[4] = { "360p", "540p", "720p", "1080p" };
+
+std::string MediaProxy::filename (const std::string &path, int height, int codec)
+{
+    // unique name for media file, resolution and codec
+    std::ostringstream name;
+    name << SystemToolkit::base_filename(path) << "_" << std::hex << std::hash<std::string>{}(path);
+    name << std::dec << "_" << height << (codec == PROXY_PRORES ? "_prores" : "_mjpeg") << ".mov";
+
+    return SystemToolkit::full_filename(SystemToolkit::full_filename(SystemToolkit::settings_path(), MEDIA_PROXY_PATH), name.str());
+}
+
+std::string MediaProxy::find (const std::string &path)
+{
+    const int h = resolution_height[ CLAMP(Settings::application.source.proxy_res, 0, 3) ];
+    const int c = Settings::application.source.proxy_codec;
+
+    {
+        std::lock_guard<std::mutex> lock(access_);
+
+        // settings changed: look for other proxies
+        if ( h != found_height_ || c != found_codec_ ) {
+            found_.clear();
+            found_height_ = h;
+            found_codec_ = c;
+        }
+
+        // already looked for it
+        auto f = found_.find(path);
+        if ( f != found_.end() )
+            return f->second;
+    }
+
+    // a proxy older than the media file is obsolete
+    std::string proxy = filename(path, h, c);
+    unsigned long long size = 0, proxy_size = 0;
+    long long mtime = 0, proxy_mtime = 0;
+    if ( !SystemToolkit::file_status(path, size, mtime) ||
+         !SystemToolkit::file_status(proxy, proxy_size, proxy_mtime) ||
+         proxy_size == 0 || proxy_mtime < mtime )
+        proxy.clear();
+
+    std::lock_guard<std::mutex> lock(access_);
+    if ( h == found_height_ && c == found_codec_ )
+        found_[path] = proxy;
+
+    return proxy;
+}
+
+void MediaProxy::generate (const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    // already working on it
+    if ( jobs_.count(path) > 0 )
+        return;
+
+    // make sure the proxy folder exists
+    const std::string folder = SystemToolkit::full_filename(SystemToolkit::settings_path(), MEDIA_PROXY_PATH);
+    if ( !SystemToolkit::file_exists(folder) && !SystemToolkit::create_directory(folder) ) {
+        Log::Warning("Cannot create folder for proxy media (%s).", folder.c_str());
+        return;
+    }
+
+    const int h = resolution_height[ CLAMP(Settings::application.source.proxy_res, 0, 3) ];
+    const int c = CLAMP(Settings::application.source.proxy_codec, 0, PROXY_CODEC_INVALID - 1);
+
+    jobs_[path] = 0.f;
+    found_.erase(path);
+    std::thread( MediaProxy::transcode, path, filename(path, h, c), h, c ).detach();
+}
+
+bool MediaProxy::busy (const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(access_);
+    return jobs_.count(path) > 0;
+}
+
+float MediaProxy::progress (const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(access_);
+    auto j = jobs_.find(path);
+    return j != jobs_.end() ? j->second : 0.f;
+}
+
+void MediaProxy::setProgress (const std::string &path, float p)
+{
+    std::lock_guard<std::mutex> lock(access_);
+    jobs_[path] = p;
+}
+
+void MediaProxy::terminate (const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(access_);
+    jobs_.erase(path);
+    found_.erase(path);
+}
+
+void MediaProxy::transcode (const std::string &path, const std::string &proxy, int height, int codec)
+{
+    const std::string uri = GstToolkit::filename_to_uri(path);
+    MediaInfo media = MediaPlayer::UriDiscoverer(uri);
+
+    if ( !media.valid || media.isimage ) {
+        Log::Warning("Cannot create proxy of '%s': not a video file.", path.c_str());
+        MediaProxy::manager().terminate(path);
+        return;
+    }
+
+    // scale down to proxy resolution, keeping aspect ratio (never upscale)
+    guint h = MIN( (guint) height, media.height);
+    guint w = (media.par_width * h) / media.height;
+    w += w % 2;
+    h += h % 2;
+
+    // decode, scale and re-encode with intra frames only
+    std::string description = "uridecodebin uri=" + uri + " ! queue ! ";
+    if (media.interlaced)
+        description += "deinterlace method=2 ! ";
+    description += "videoconvert ! videoscale ! video/x-raw, pixel-aspect-ratio=1/1, ";
+    description += "width=" + std::to_string(w) + ", height=" + std::to_string(h) + " ! ";
+    // same encoders as for recording
+    if (codec == PROXY_PRORES)
+        description += VideoRecorder::profile_description[VideoRecorder::PRORES_STANDARD];
+    else
+        description += VideoRecorder::profile_description[VideoRecorder::JPEG_MULTI];
+    description += "qtmux ! filesink name=sink sync=false";
+
+    GError *error = NULL;
+    GstElement *pipeline = gst_parse_launch (description.c_str(), &error);
+    if (error != NULL) {
+        Log::Warning("Cannot create proxy of '%s': %s", path.c_str(), error->message);
+        g_clear_error (&error);
+        if (pipeline)
+            gst_object_unref (pipeline);
+        MediaProxy::manager().terminate(path);
+        return;
+    }
+
+    // write in a temporary file, renamed when complete
+    const std::string partial = proxy + ".part";
+    GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+    g_object_set (G_OBJECT (sink), "location", partial.c_str(), NULL);
+    gst_object_unref (sink);
+
+    Log::Info("Creating %s proxy of '%s' (%d x %d).", codec_name[codec], path.c_str(), w, h);
+
+    bool success = false;
+    if ( gst_element_set_state (pipeline, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE ) {
+
+        GstBus *bus = gst_element_get_bus (pipeline);
+        bool done = false;
+        while (!done) {
+            GstMessage *msg = gst_bus_timed_pop_filtered (bus, 250 * GST_MSECOND,
+                                  (GstMessageType) (GST_MESSAGE_EOS | GST_MESSAGE_ERROR) );
+            if (msg == NULL) {
+                // no news: update progress
+                gint64 pos = 0, duration = 0;
+                if ( gst_element_query_position (pipeline, GST_FORMAT_TIME, &pos) &&
+                     gst_element_query_duration (pipeline, GST_FORMAT_TIME, &duration) && duration > 0 )
+                    MediaProxy::manager().setProgress(path, (float) pos / (float) duration);
+                continue;
+            }
+
+            if ( GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR ) {
+                GError *err = NULL;
+                gst_message_parse_error (msg, &err, NULL);
+                Log::Warning("Failed to create proxy of '%s': %s", path.c_str(), err ? err->message : "");
+                g_clear_error (&err);
+            }
+            else
+                success = true;
+
+            gst_message_unref (msg);
+            done = true;
+        }
+        gst_object_unref (bus);
+    }
+
+    gst_element_set_state (pipeline, GST_STATE_NULL);
+    gst_object_unref (pipeline);
+
+    if ( success && std::rename(partial.c_str(), proxy.c_str()) == 0 )
+        Log::Notify("Proxy of '%s' is ready.", SystemToolkit::filename(path).c_str());
+    else
+        std::remove(partial.c_str());
+
+    MediaProxy::manager().terminate(path);
+}
@@ -0,0 +1,70 @@
+#ifndef MEDIAPROXY_H
+#define MEDIAPROXY_H
+
+#include <string>
+#include <map>
+#include <mutex>
+
+/**
+ * @brief The MediaProxy manages intra-frame only copies of media files.
+ *
+ * Long-GOP codecs (h264, h265, vp9...) are slow to seek and to play
+ * in reverse; a proxy encoded with every frame as a keyframe (Motion-JPEG
+ * or ProRes) at a reduced resolution makes stepping and scrubbing cheap.
+ *
+ * Proxies are transcoded in background and stored in the settings folder.
+ * MediaPlayer opens the proxy instead of the original file when a valid
+ * one exists; sessions keep referencing the original file.
+ */
+class MediaProxy
+{
+    // Private Constructor
+    MediaProxy() : found_height_(0), found_codec_(0) {}
+    MediaProxy(MediaProxy const& copy) = delete;
+    MediaProxy& operator=(MediaProxy const& copy) = delete;
+
+public:
+
+    static MediaProxy& manager ()
+    {
+        // The only instance
+        static MediaProxy _instance;
+        return _instance;
+    }
+
+    typedef enum {
+        PROXY_MJPEG = 0,
+        PROXY_PRORES,
+        PROXY_CODEC_INVALID
+    } Codec;
+    static const char* codec_name[PROXY_CODEC_INVALID];
+    static const int resolution_height[4];
+    static const char* resolution_name[4];
+
+    // filename of a valid proxy of the media file, empty if none
+    // (remembered until proxy is generated or settings change)
+    std::string find (const std::string &path);
+    // start transcoding the proxy of the media file in background
+    void generate (const std::string &path);
+    // true if proxy of media file is being transcoded
+    bool busy (const std::string &path);
+    // progress of transcoding [0 1]
+    float progress (const std::string &path);
+
+private:
+
+    std::map<std::string, float> jobs_;
+    std::mutex access_;
+
+    // proxy found for media files, with the settings used
+    std::map<std::string, std::string> found_;
+    int found_height_;
+    int found_codec_;
+
+    static std::string filename (const std::string &path, int height, int codec);
+    static void transcode (const std::string &path, const std::string &proxy, int height, int codec);
+    void setProgress (const std::string &path, float p);
+    void terminate (const std::string &path);
+};
+
+#endif // MEDIAPROXY_H
@@ -25,10 +25,11 @@
 #include "MediaPlayer.h"
 #include "Visitor.h"
 #include "Log.h"
+#include "Mixer.h"
 
 #include "MediaSource.h"
 
-MediaSource::MediaSource(uint64_t id) : Source(id), path_("")
+MediaSource::MediaSource(uint64_t id) : Source(id), path_(""), rendered_frame_(0)
 {
     // create media player
     mediaplayer_ = new MediaPlayer;
@@ -171,6 +172,14 @@ void MediaSource::update(float dt)
 {
     Source::update(dt);
 
+    // height of the source in the output frame, for automatic decode resolution
+    // NB: clones can be displayed larger; keep full resolution
+    guint display_height = 0;
+    FrameBuffer *output = Mixer::manager().session()->frame();
+    if ( !cloned() && output != nullptr )
+        display_height = (guint) ( ABS(groups_[View::GEOMETRY]->scale_.y) * output->height() );
+    mediaplayer_->setDisplayHeight( display_height );
+
     // update video
     mediaplayer_->update();
 }
@@ -181,15 +190,28 @@ void MediaSource::render()
         init();
     else {
         // render the media player into frame buffer
-        renderbuffer_->begin();
+        // NB: texture is re-created when decode resolution changes
+        texturesurface_->setTextureIndex( mediaplayer_->texture() );
         // apply fading
         texturesurface_->shader()->color = glm::vec4( glm::vec3(mediaplayer_->currentTimelineFading()), 1.f);
+        // nothing changed since last render (e.g. paused or image)
+        if ( !renderNeeded() )
+            return;
+        renderbuffer_->begin();
         texturesurface_->draw(glm::identity<glm::mat4>(), renderbuffer_->projection());
         renderbuffer_->end();
         ready_ = true;
     }
 }
 
+bool MediaSource::textureChanged()
+{
+    uint64_t f = mediaplayer_->frameCount();
+    bool changed = ( f != rendered_frame_ );
+    rendered_frame_ = f;
+    return changed;
+}
+
 void MediaSource::accept(Visitor& v)
 {
     Source::accept(v);
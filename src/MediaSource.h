@@ -35,9 +35,11 @@ public:
 protected:
 
     void init() override;
+    bool textureChanged() override;
 
     std::string path_;
     MediaPlayer *mediaplayer_;
+    uint64_t rendered_frame_;
 };
 
 #endif // MEDIASOURCE_H
@@ -344,22 +344,31 @@ bool parsePLY(string ascii,
 
 
 
-Mesh::Mesh(const std::string& ply_path, const std::string& tex_path) : Primitive(), mesh_resource_(ply_path), texture_resource_(tex_path), textureindex_(0)
+// Vertex array of a mesh file, shared by all meshes created from it
+struct Mesh::Geometry
 {
-    if ( !parsePLY( Resource::getText(mesh_resource_), points_, colors_, texCoords_, indices_, drawMode_) )
-    {
-        points_.clear();
-        colors_.clear();
-        texCoords_.clear();
-        indices_.clear();
-        Log::Warning("Mesh could not be created from %s", ply_path.c_str());
-    }
+    uint vao;
+    uint drawMode;
+    uint drawCount;
+    GlmToolkit::AxisAlignedBoundingBox bbox;
+};
 
+// Geometries are created once for the whole application (never deleted)
+std::map<std::string, Mesh::Geometry> Mesh::geometries_;
+
+Mesh::Mesh(const std::string& ply_path, const std::string& tex_path) : Primitive(), mesh_resource_(ply_path), texture_resource_(tex_path), textureindex_(0)
+{
     // default non texture shader (deleted in Primitive)
     shader_ = new Shader;
 }
 
 
+Mesh::~Mesh()
+{
+    // do not delete the shared vertex array in Primitive
+    vao_ = 0;
+}
+
 void Mesh::setTexture(uint textureindex)
 {
     if (textureindex) {
@@ -372,7 +381,34 @@ void Mesh::setTexture(uint textureindex)
 
 void Mesh::init()
 {
-    Primitive::init();
+    auto g = geometries_.find(mesh_resource_);
+
+    // first mesh created from this file: parse and create vertex array
+    if ( g == geometries_.end() ) {
+
+        if ( !parsePLY( Resource::getText(mesh_resource_), points_, colors_, texCoords_, indices_, drawMode_) )
+        {
+            points_.clear();
+            colors_.clear();
+            texCoords_.clear();
+            indices_.clear();
+            Log::Warning("Mesh could not be created from %s", mesh_resource_.c_str());
+        }
+
+        // never delete the shared vertex array
+        vao_ = 0;
+        Primitive::init();
+
+        geometries_.emplace(mesh_resource_, Geometry{vao_, drawMode_, drawCount_, bbox_});
+    }
+    // otherwise use the vertex array of the file
+    else {
+        vao_ = g->second.vao;
+        drawMode_ = g->second.drawMode;
+        drawCount_ = g->second.drawCount;
+        bbox_ = g->second.bbox;
+        Node::init();
+    }
 
     if (!texture_resource_.empty())
         setTexture(Resource::getTextureImage(texture_resource_));
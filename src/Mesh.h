@@ -2,6 +2,7 @@
 #define MESH_H
 
 #include <string>
+#include <map>
 
 #include "Scene.h"
 
@@ -16,6 +17,7 @@ class Mesh : public Primitive {
 
 public:
     Mesh(const std::string& ply_path, const std::string& tex_path = "");
+    ~Mesh();
 
     void setTexture(uint textureindex);
     inline uint texture() const { return textureindex_; }
@@ -32,6 +34,10 @@ protected:
     std::string texture_resource_;
     uint textureindex_;
 
+    // vertex array shared by meshes of the same file
+    struct Geometry;
+    static std::map<std::string, Geometry> geometries_;
+
 };
 
 
@@ -43,6 +43,7 @@
 #include "CloneSource.h"
 #include "RenderSource.h"
 #include "MediaSource.h"
+#include "MediaPlayer.h"
 #include "PatternSource.h"
 #include "DeviceSource.h"
 #include "MultiFileSource.h"
@@ -244,13 +245,15 @@ void Mixer::update()
         }
     }
 
-    // update views
-    mixing_.update(dt_);
-    geometry_.update(dt_);
-    layer_.update(dt_);
-    appearance_.update(dt_);
-    transition_.update(dt_);
-    displays_.update(dt_);
+    // update current view (and transition view, which drives transitions);
+    // other views only animate their sources and catch up when displayed
+    View *views[] = { &mixing_, &geometry_, &layer_, &appearance_, &transition_, &displays_ };
+    for (View *v : views) {
+        if ( v == current_view_ || v == &transition_ )
+            v->update(dt_);
+        else
+            v->updateHidden(dt_);
+    }
 
     // deep update was performed
     if  (View::need_deep_update_ > 0)
@@ -903,6 +906,17 @@ void Mixer::groupSession()
     Log::Notify("Switched to session '%s'", sessiongroup->name().c_str());
 }
 
+void Mixer::prerollBatch(size_t i)
+{
+    // prepare media sources of batch to start playing immediately
+    SourceList _batch = session_->getBatch(i);
+    for (auto it = _batch.begin(); it != _batch.end(); ++it) {
+        MediaSource *ms = dynamic_cast<MediaSource *>(*it);
+        if (ms != nullptr)
+            ms->mediaplayer()->preroll();
+    }
+}
+
 void Mixer::renameSource(Source *s, const std::string &newname)
 {
     if ( s != nullptr )
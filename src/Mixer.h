@@ -73,6 +73,9 @@ public:
     void ungroupAll ();
     void groupSession ();
 
+    // operations on batch
+    void prerollBatch (size_t i);
+
     // current source
     Source *currentSource ();
     void setCurrentSource (Source *s);
@@ -275,6 +275,10 @@ Rendering::Rendering()
 {
 //    main_window_ = nullptr;
     request_screenshot_ = false;
+    timing_ = { 0.f, 0.f, 0.f, 0.f, 0 };
+    next_frame_time_ = 0;
+    late_ = false;
+    interface_skipped_ = 0;
 }
 
 bool Rendering::init()
@@ -427,8 +431,30 @@ void Rendering::pushBackDrawCallback(RenderingCallback function)
     draw_callbacks_.push_back(function);
 }
 
+void Rendering::pushBackInterfaceCallback(RenderingCallback function)
+{
+    interface_callbacks_.push_back(function);
+}
+
+double Rendering::frameRate()
+{
+    // fixed frame rate
+    if ( Settings::application.render.framerate > 0.f )
+        return Settings::application.render.framerate;
+
+    // refresh rate of the monitor of the first output window (or main window)
+    GLFWmonitor *mo = Settings::application.num_output_windows > 0 ? outputs_[0].monitor() : main_.monitor();
+    const GLFWvidmode *mode = mo ? glfwGetVideoMode(mo) : nullptr;
+    if ( mode && mode->refreshRate > 0 )
+        return mode->refreshRate;
+
+    return 60.0;
+}
+
 void Rendering::draw()
 {
+    const int64_t t_start = g_get_monotonic_time();
+
     // Poll and handle events (inputs, window resize, etc.)
     // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
     // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application.
@@ -456,12 +482,29 @@ void Rendering::draw()
     {
         (*iter)();
     }
+    const int64_t t_update = g_get_monotonic_time();
+
+    // draw user interface, unless previous frame was late
+    // (skip at most RENDERING_MAX_SKIPPED_FRAMES in a row)
+    const bool draw_interface = !late_ || interface_skipped_ >= RENDERING_MAX_SKIPPED_FRAMES;
+    if (draw_interface) {
+        for (iter=interface_callbacks_.begin(); iter != interface_callbacks_.end(); ++iter)
+        {
+            (*iter)();
+        }
 
-    // perform screenshot if requested
-    if (request_screenshot_) {
-        screenshot_.captureGL(main_.width(), main_.height());
-        request_screenshot_ = false;
+        // perform screenshot if requested
+        if (request_screenshot_) {
+            screenshot_.captureGL(main_.width(), main_.height());
+            request_screenshot_ = false;
+        }
+        interface_skipped_ = 0;
+    }
+    else {
+        ++interface_skipped_;
+        ++timing_.dropped;
     }
+    const int64_t t_interface = g_get_monotonic_time();
 
     // draw output windows and count number of success
     int count = 0;
@@ -477,19 +520,32 @@ void Rendering::draw()
         outputs_[count].show();
     }
 
+    const int64_t t_outputs = g_get_monotonic_time();
+
     // swap all GL buffers at once
-    main_.swap();
+    if (draw_interface)
+        main_.swap();
     for (auto it = outputs_.begin(); it != outputs_.end(); ++it)
         it->swap();
-
-    // software framerate limiter < 62 FPS
-    {
-        static GTimer *timer = g_timer_new ();
-        double elapsed = g_timer_elapsed (timer, NULL) * 1000000.0;
-        if ( (elapsed < 16000.0) && (elapsed > 0.0) )
-            g_usleep( 16000 - (gulong)elapsed  );
-        g_timer_start(timer);
-    }
+    const int64_t t_swap = g_get_monotonic_time();
+
+    // average duration of stages
+    timing_.update    += 0.05f * ( 0.001f * float(t_update - t_start) - timing_.update );
+    if (draw_interface)
+        timing_.interface += 0.05f * ( 0.001f * float(t_interface - t_update) - timing_.interface );
+    timing_.outputs   += 0.05f * ( 0.001f * float(t_outputs - t_interface) - timing_.outputs );
+    timing_.swap      += 0.05f * ( 0.001f * float(t_swap - t_outputs) - timing_.swap );
+
+    // frame pacing: wait for the time of next frame at the target frame rate
+    const int64_t period = (int64_t) ( 1000000.0 / frameRate() );
+    late_ = (t_outputs - t_start) > period;
+    next_frame_time_ += period;
+    const int64_t now = g_get_monotonic_time();
+    if ( next_frame_time_ > now )
+        g_usleep( next_frame_time_ - now );
+    // more than one frame late: do not try to catch up
+    else if ( now - next_frame_time_ > period )
+        next_frame_time_ = now;
 }
 
 void Rendering::terminate()
@@ -658,9 +714,13 @@ bool Rendering::shouldHaveEnoughMemory(glm::vec3 resolution, int flags)
     glm::ivec2 RAM = getGPUMemoryInformation();
 
     // approximation of RAM needed for such FBO
-    GLint framebufferMemoryInKB = ( resolution.x * resolution.x *
+    GLint framebufferMemoryInKB = ( resolution.x * resolution.y *
                                     ((flags & FrameBuffer::FrameBuffer_alpha)?4:3) * ((flags & FrameBuffer::FrameBuffer_multisampling)?2:1) ) / 1024;
 
+    // respect the budget of memory for framebuffers
+    if ( !FrameBufferPool::manager().canAllocate(framebufferMemoryInKB) )
+        return false;
+
     return ( RAM.x > framebufferMemoryInKB * 3 );
 }
 
@@ -13,6 +13,9 @@
 
 //#define USE_GST_OPENGL_SYNC_HANDLER
 
+// maximum number of consecutive frames without user interface
+#define RENDERING_MAX_SKIPPED_FRAMES 3
+
 typedef struct GLFWmonitor GLFWmonitor;
 typedef struct GLFWwindow GLFWwindow;
 class FrameBuffer;
@@ -132,6 +135,20 @@ public:
     // add function to call during draw
     typedef void (* RenderingCallback)(void);
     void pushBackDrawCallback(RenderingCallback function);
+    // add function to call to draw the user interface (skipped when late)
+    void pushBackInterfaceCallback(RenderingCallback function);
+
+    // frame rate targeted by the draw loop (Hz)
+    double frameRate();
+    // average duration of each stage of the draw loop (ms)
+    struct FrameTiming {
+        float update;
+        float interface;
+        float outputs;
+        float swap;
+        uint64_t dropped;
+    };
+    inline FrameTiming frameTiming() const { return timing_; }
 
     // push and pop rendering attributes
     void pushAttrib(RenderingAttrib ra);
@@ -190,6 +207,13 @@ private:
 
     // list of functions to call at each Draw
     std::list<RenderingCallback> draw_callbacks_;
+    std::list<RenderingCallback> interface_callbacks_;
+
+    // frame pacing
+    FrameTiming timing_;
+    int64_t next_frame_time_;
+    bool late_;
+    uint interface_skipped_;
 
     // windows
     RenderingWindow main_;
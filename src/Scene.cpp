@@ -50,6 +50,10 @@ Node::Node() : initialized_(false), visible_(true), refcount_(0)
     rotation_ = glm::vec3(0.f);
     translation_ = glm::vec3(0.f);
     crop_ = glm::vec3(1.f);
+
+    transform_scale_ = scale_;
+    transform_rotation_ = rotation_;
+    transform_translation_ = translation_;
 #if DEBUG_SCENE
     num_nodes_++;
 #endif
@@ -79,6 +83,9 @@ void Node::copyTransform(const Node *other)
     if (!other)
         return;
     transform_ = other->transform_;
+    transform_scale_ = other->transform_scale_;
+    transform_rotation_ = other->transform_rotation_;
+    transform_translation_ = other->transform_translation_;
     scale_ = other->scale_;
     rotation_ = other->rotation_;
     translation_ = other->translation_;
@@ -101,8 +108,13 @@ void Node::update( float dt)
             ++iter;
     }
 
-    // update transform matrix from attributes
-    transform_ = GlmToolkit::transform(translation_, rotation_, scale_);
+    // update transform matrix from attributes (only if changed)
+    if ( translation_ != transform_translation_ || rotation_ != transform_rotation_ || scale_ != transform_scale_ ) {
+        transform_ = GlmToolkit::transform(translation_, rotation_, scale_);
+        transform_translation_ = translation_;
+        transform_rotation_ = rotation_;
+        transform_scale_ = scale_;
+    }
 }
 
 void Node::accept(Visitor& v)
@@ -42,6 +42,9 @@ class Node {
     uint64_t  id_;
     bool      initialized_;
 
+    // attributes used to compute transform_
+    glm::vec3 transform_scale_, transform_rotation_, transform_translation_;
+
 public:
     Node ();
     virtual ~Node ();
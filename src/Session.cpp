@@ -30,6 +30,7 @@
 #include "SessionVisitor.h"
 #include "ActionManager.h"
 #include "RenderSource.h"
+#include "CloneSource.h"
 #include "MixingGroup.h"
 #include "ControlManager.h"
 #include "SourceCallback.h"
@@ -44,7 +45,7 @@ SessionNote::SessionNote(const std::string &t, bool l, int s): label(std::to_str
 }
 
 Session::Session(uint64_t id) : id_(id), active_(true), activation_threshold_(MIXING_MIN_THRESHOLD),
-    filename_(""), thumbnail_(nullptr), ready_(false)
+    filename_(""), render_order_changed_(true), thumbnail_(nullptr), ready_(false)
 {
     // create unique id
     if (id_ == 0)
@@ -264,9 +265,13 @@ void Session::update(float dt)
         }
     }
 
-    // pre-render all sources
+    // sort sources after change in the list
+    if (render_order_changed_)
+        updateRenderOrder();
+
+    // update all sources, dependencies first
     ready_ = true;
-    for( SourceList::iterator it = sources_.begin(); it != sources_.end(); ++it){
+    for( SourceList::iterator it = render_order_.begin(); it != render_order_.end(); ++it){
 
         // ensure the RenderSource is rendering *this* session
         RenderSource *rs = dynamic_cast<RenderSource *>( *it );
@@ -283,7 +288,7 @@ void Session::update(float dt)
                 failed_.insert( *it );
             }
         }
-        // render normally
+        // update normally
         else {
             // session is not ready if one source is not ready
             if ( !(*it)->ready() )
@@ -291,11 +296,26 @@ void Session::update(float dt)
             // update the source
             (*it)->setActive(activation_threshold_);
             (*it)->update(dt);
-            // render the source
-            (*it)->render();
         }
     }
 
+    // visibility of sources in the area of the output frame
+    // (clones first: the origin of a visible clone is visible)
+    GlmToolkit::AxisAlignedBoundingBox area;
+    area.extend( glm::vec3( -render_.frame()->aspectRatio(), -1.f, 0.f) );
+    area.extend( glm::vec3(  render_.frame()->aspectRatio(),  1.f, 0.f) );
+    for( SourceList::reverse_iterator it = render_order_.rbegin(); it != render_order_.rend(); ++it){
+        if ( !(*it)->failed() )
+            (*it)->updateVisibility(area);
+    }
+
+    // pre-render all sources, dependencies first,
+    // unless their output cannot be seen
+    for( SourceList::iterator it = render_order_.begin(); it != render_order_.end(); ++it){
+        if ( !(*it)->failed() && ( (*it)->visible() || !(*it)->ready() ) )
+            (*it)->render();
+    }
+
     // update session's mixing groups
     auto group_iter = mixing_groups_.begin();
     while ( group_iter != mixing_groups_.end() ){
@@ -344,6 +364,50 @@ void Session::update(float dt)
         render_.drawThumbnail();
 }
 
+void Session::updateRenderOrder()
+{
+    // The only dependency between sources of a session is
+    // a CloneSource rendering the frame of its origin.
+    // NB: a RenderSource reads the output of the session at the
+    // previous frame (it is part of it), and a SessionSource renders
+    // its own session: their order does not matter.
+    render_order_.clear();
+
+    // depth first sorting of the forest of clones
+    // (0: not visited, 1: visiting, 2: sorted)
+    std::map<Source *, int> state;
+    for (auto it = sources_.begin(); it != sources_.end(); ++it)
+        state[*it] = 0;
+
+    for (auto it = sources_.begin(); it != sources_.end(); ++it) {
+
+        // follow the chain of origins until a sorted source
+        std::list<Source *> chain;
+        Source *s = *it;
+        while ( s != nullptr && state[s] == 0 ) {
+            state[s] = 1;
+            chain.push_front(s);
+            CloneSource *cs = dynamic_cast<CloneSource *>(s);
+            s = cs != nullptr ? cs->origin() : nullptr;
+            // ignore origins outside of the session
+            if ( s != nullptr && state.count(s) < 1 )
+                s = nullptr;
+        }
+
+        // back to a source of the chain: this is a loop
+        if ( s != nullptr && state[s] == 1 )
+            Log::Warning("Session cannot render '%s' after its origin (cyclic dependency).", s->name().c_str());
+
+        // origins first
+        for (auto c = chain.begin(); c != chain.end(); ++c) {
+            state[*c] = 2;
+            render_order_.push_back(*c);
+        }
+    }
+
+    render_order_changed_ = false;
+}
+
 SourceList::iterator Session::addSource(Source *s)
 {
     // lock before change
@@ -358,6 +422,7 @@ SourceList::iterator Session::addSource(Source *s)
         attachSource(s);
         // insert the source to the end of the list
         sources_.push_back(s);
+        render_order_changed_ = true;
         // return the iterator to the source created at the end
         its = --sources_.end();
     }
@@ -383,6 +448,7 @@ SourceList::iterator Session::deleteSource(Source *s)
         failed_.erase(s);
         // erase the source from the update list & get next element
         its = sources_.erase(its);
+        render_order_changed_ = true;
         // delete the source : safe now
         delete s;
     }
@@ -411,6 +477,7 @@ SourceList::iterator Session::removeSource(Source *s)
         failed_.erase(s);
         // erase the source from the update list & get next element
         ret = sources_.erase(its);
+        render_order_changed_ = true;
     }
 
     // unlock access
@@ -432,6 +499,7 @@ Source *Session::popSource()
         detachSource(s);
         // erase the source from the update list & get next element
         sources_.erase(its);
+        render_order_changed_ = true;
     }
 
     return s;
@@ -604,6 +672,7 @@ void Session::move(int current_index, int target_index)
     Source *s = (*from);
     sources_.erase(from);
     sources_.insert(to, s);
+    render_order_changed_ = true;
 }
 
 bool Session::canlink (SourceList sources)
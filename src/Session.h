@@ -194,6 +194,10 @@ protected:
     SourceListUnique failed_;
     SourceList sources_;
     void validate(SourceList &sources);
+    // sources in order of rendering (dependencies first)
+    SourceList render_order_;
+    bool render_order_changed_;
+    void updateRenderOrder();
     std::list<SessionNote> notes_;
     std::list<MixingGroup *> mixing_groups_;
     std::map<View::Mode, Group*> config_;
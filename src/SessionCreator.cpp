@@ -879,6 +879,14 @@ void SessionLoader::visit(MediaPlayer &n)
             mediaplayerNode->QueryBoolAttribute("rewind_on_disabled", &rewind_on_disabled);
             n.setRewindOnDisabled(rewind_on_disabled);
 
+            bool gapless = false;
+            mediaplayerNode->QueryBoolAttribute("gapless", &gapless);
+            n.setGapless(gapless);
+
+            int decode_limit = DECODE_FULL;
+            mediaplayerNode->QueryIntAttribute("decode_limit", &decode_limit);
+            n.setDecodeLimit(decode_limit);
+
             int sync_to_metronome = 0;
             mediaplayerNode->QueryIntAttribute("sync_to_metronome", &sync_to_metronome);
             n.setSyncToMetronome( (Metronome::Synchronicity) sync_to_metronome);
@@ -1259,6 +1267,19 @@ void SessionLoader::visit (DelayFilter& f)
     double d = 0.0;
     xmlCurrent_->QueryDoubleAttribute("delay", &d);
     f.setDelay(d);
+    bool b = false;
+    xmlCurrent_->QueryBoolAttribute("downscale", &b);
+    f.setDownscale(b);
+}
+
+void SessionLoader::visit (TimeMachineFilter& f)
+{
+    double d = 5.0;
+    xmlCurrent_->QueryDoubleAttribute("history", &d);
+    f.setHistory(d);
+    d = 1.0;
+    xmlCurrent_->QueryDoubleAttribute("speed", &d);
+    f.setSpeed(d);
 }
 
 void SessionLoader::visit (ResampleFilter& f)
@@ -1362,17 +1383,32 @@ void SessionLoader::visit (ImageFilter& f)
 
 void SessionLoader::visit (CloneSource& s)
 {
-    // configuration of filter in clone
-    xmlCurrent_ = xmlCurrent_->FirstChildElement("Filter");
-    if (xmlCurrent_) {
+    XMLElement *cloneNode = xmlCurrent_;
+
+    // configuration of filters in clone, in order of chain
+    size_t i = 0;
+    xmlCurrent_ = cloneNode->FirstChildElement("Filter");
+    for ( ; xmlCurrent_ ; xmlCurrent_ = xmlCurrent_->NextSiblingElement("Filter")) {
         // get type of filter and create
         int t = 0;
         xmlCurrent_->QueryIntAttribute("type", &t);
-        s.setFilter( FrameBufferFilter::Type(t) );
+        if ( i < s.numFilters() )
+            s.setFilter( FrameBufferFilter::Type(t), i );
+        else
+            s.addFilter( FrameBufferFilter::Type(t) );
 
         // set config filter
-        s.filter()->accept(*this);
+        if ( s.filter(i) && s.filter(i)->type() == FrameBufferFilter::Type(t) ) {
+            s.filter(i)->accept(*this);
+            ++i;
+        }
     }
+
+    // remove filters not in the chain
+    while ( i > 0 && s.numFilters() > i )
+        s.removeFilter( s.numFilters() - 1 );
+
+    xmlCurrent_ = cloneNode;
 }
 
 void SessionLoader::visit (SourceCallback &)
@@ -66,6 +66,7 @@ public:
     void visit (CloneSource& s) override;
     void visit (FrameBufferFilter&) override;
     void visit (DelayFilter&) override;
+    void visit (TimeMachineFilter&) override;
     void visit (ResampleFilter&) override;
     void visit (BlurFilter&) override;
     void visit (SharpenFilter&) override;
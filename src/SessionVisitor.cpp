@@ -416,6 +416,8 @@ void SessionVisitor::visit(MediaPlayer &n)
         newelement->SetAttribute("speed", n.playSpeed());
         newelement->SetAttribute("software_decoding", n.softwareDecodingForced());
         newelement->SetAttribute("rewind_on_disabled", n.rewindOnDisabled());
+        newelement->SetAttribute("gapless", n.gapless());
+        newelement->SetAttribute("decode_limit", n.decodeLimit());
         newelement->SetAttribute("sync_to_metronome", (int) n.syncToMetronome());
 
         // timeline
@@ -693,6 +695,13 @@ void SessionVisitor::visit (FrameBufferFilter& f)
 void SessionVisitor::visit (DelayFilter& f)
 {
     xmlCurrent_->SetAttribute("delay", f.delay());
+    xmlCurrent_->SetAttribute("downscale", f.downscale());
+}
+
+void SessionVisitor::visit (TimeMachineFilter& f)
+{
+    xmlCurrent_->SetAttribute("history", f.history());
+    xmlCurrent_->SetAttribute("speed", f.speed());
 }
 
 void SessionVisitor::visit (ResampleFilter& f)
@@ -758,7 +767,8 @@ void SessionVisitor::visit (ImageFilter& f)
     xmlCurrent_->SetAttribute("name", f.program().name().c_str() );
 
     // image filter code
-    std::pair< std::string, std::string > filter_codes = f.program().code();
+    FilteringProgram program = f.program();
+    std::pair< std::string, std::string > filter_codes = program.code();
     XMLElement *firstpass = xmlDoc_->NewElement( "firstpass" );
     xmlCurrent_->InsertEndChild(firstpass);
     {
@@ -791,10 +801,12 @@ void SessionVisitor::visit (CloneSource& s)
         origin->InsertEndChild( text );
     }
 
-    // Filter
-    xmlCurrent_ = xmlDoc_->NewElement( "Filter" );
-    s.filter()->accept(*this);
-    cloneNode->InsertEndChild(xmlCurrent_);
+    // Filters, in order of chain
+    for (size_t i = 0; i < s.numFilters(); ++i) {
+        xmlCurrent_ = xmlDoc_->NewElement( "Filter" );
+        s.filter(i)->accept(*this);
+        cloneNode->InsertEndChild(xmlCurrent_);
+    }
 
     xmlCurrent_ = cloneNode;  // parent for next visits (other subtypes of Source)
 }
@@ -172,6 +172,13 @@ void Settings::Save(uint64_t runtime)
     RenderNode->SetAttribute("vsync", application.render.vsync);
     RenderNode->SetAttribute("multisampling", application.render.multisampling);
     RenderNode->SetAttribute("gpu_decoding", application.render.gpu_decoding);
+    RenderNode->SetAttribute("yuv_upload", application.render.yuv_upload);
+    RenderNode->SetAttribute("frame_cache", application.render.frame_cache);
+    RenderNode->SetAttribute("program_cache", application.render.program_cache);
+    RenderNode->SetAttribute("gpu_budget", application.render.gpu_budget);
+    RenderNode->SetAttribute("framerate", application.render.framerate);
+    RenderNode->SetAttribute("blur_quality", application.render.blur_quality);
+    RenderNode->SetAttribute("compute_filters", application.render.compute_filters);
     RenderNode->SetAttribute("ratio", application.render.ratio);
     RenderNode->SetAttribute("res", application.render.res);
     RenderNode->SetAttribute("custom_width", application.render.custom_width);
@@ -206,6 +213,9 @@ void Settings::Save(uint64_t runtime)
     SourceConfNode->SetAttribute("capture_naming", application.source.capture_naming);
     SourceConfNode->SetAttribute("capture_path", application.source.capture_path.c_str());
     SourceConfNode->SetAttribute("inspector_zoom", application.source.inspector_zoom);
+    SourceConfNode->SetAttribute("proxy", application.source.proxy);
+    SourceConfNode->SetAttribute("proxy_codec", application.source.proxy_codec);
+    SourceConfNode->SetAttribute("proxy_res", application.source.proxy_res);
     pRoot->InsertEndChild(SourceConfNode);
 
     // Brush
@@ -455,6 +465,13 @@ void Settings::Load()
         rendernode->QueryIntAttribute("vsync", &application.render.vsync);
         rendernode->QueryIntAttribute("multisampling", &application.render.multisampling);
         rendernode->QueryBoolAttribute("gpu_decoding", &application.render.gpu_decoding);
+        rendernode->QueryBoolAttribute("yuv_upload", &application.render.yuv_upload);
+        rendernode->QueryIntAttribute("frame_cache", &application.render.frame_cache);
+        rendernode->QueryBoolAttribute("program_cache", &application.render.program_cache);
+        rendernode->QueryIntAttribute("gpu_budget", &application.render.gpu_budget);
+        rendernode->QueryFloatAttribute("framerate", &application.render.framerate);
+        rendernode->QueryIntAttribute("blur_quality", &application.render.blur_quality);
+        rendernode->QueryBoolAttribute("compute_filters", &application.render.compute_filters);
         rendernode->QueryIntAttribute("ratio", &application.render.ratio);
         rendernode->QueryIntAttribute("res", &application.render.res);
         rendernode->QueryIntAttribute("custom_width", &application.render.custom_width);
@@ -494,6 +511,9 @@ void Settings::Load()
         else
             application.source.capture_path = SystemToolkit::home_path();
         sourceconfnode->QueryFloatAttribute("inspector_zoom", &application.source.inspector_zoom);
+        sourceconfnode->QueryBoolAttribute("proxy", &application.source.proxy);
+        sourceconfnode->QueryIntAttribute("proxy_codec", &application.source.proxy_codec);
+        sourceconfnode->QueryIntAttribute("proxy_res", &application.source.proxy_res);
     }
 
     // Transition
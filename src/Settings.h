@@ -178,6 +178,13 @@ struct RenderConfig
     float fading;
     bool gpu_decoding;
     bool gpu_decoding_available;
+    bool yuv_upload;
+    int frame_cache;
+    bool program_cache;
+    int gpu_budget;
+    float framerate;
+    int blur_quality;
+    bool compute_filters;
 
     RenderConfig() {
         disabled = false;
@@ -190,6 +197,13 @@ struct RenderConfig
         fading = 0.0;
         gpu_decoding = true;
         gpu_decoding_available = false;
+        yuv_upload = false;
+        frame_cache = 512;
+        program_cache = true;
+        gpu_budget = 4096;
+        framerate = 0.f;
+        blur_quality = 1;
+        compute_filters = true;
     }
 };
 
@@ -201,6 +215,9 @@ struct SourceConfig
     std::string capture_path;
     int capture_naming;
     float inspector_zoom;
+    bool proxy;
+    int proxy_codec;
+    int proxy_res;
 
     SourceConfig() {
         new_type = 0;
@@ -208,6 +225,9 @@ struct SourceConfig
         res = 1;
         capture_naming = 0;
         inspector_zoom = 8.f;
+        proxy = true;
+        proxy_codec = 0;
+        proxy_res = 2;
     }
 };
 
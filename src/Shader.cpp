@@ -23,6 +23,9 @@
 #include <regex>
 #include <chrono>
 #include <ctime>
+#include <cstdio>
+#include <map>
+#include <iterator>
 
 #include <glad/glad.h> 
 #include <GLFW/glfw3.h>
@@ -31,10 +34,13 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/string_cast.hpp>
 
+#include "defines.h"
 #include "Resource.h"
 #include "Log.h"
 #include "Visitor.h"
 #include "BaseToolkit.h"
+#include "SystemToolkit.h"
+#include "Settings.h"
 #include "RenderingManager.h"
 
 #include "Shader.h"
@@ -43,8 +49,14 @@
 //#define SHADER_DEBUG
 #endif
 
+// Uniform block of transformation matrices (see image.vs and simple.vs)
+#define MATRICES_BLOCK_NAME "Matrices"
+#define MATRICES_BINDING 0
+
 // Globals
 ShadingProgram *ShadingProgram::currentProgram_ = nullptr;
+unsigned int ShadingProgram::matrices_buffer_ = 0;
+bool ShadingProgram::matrices_bound_ = false;
 ShadingProgram simpleShadingProgram("shaders/simple.vs", "shaders/simple.fs");
 
 // Blending presets for matching with Shader::BlendModes:
@@ -76,8 +88,171 @@ GLenum blending_destination_function[9] = {GL_ONE_MINUS_SRC_ALPHA,// normal
                                            GL_ONE,   // lighten only
                                            GL_ZERO};
 
+//
+// GL Programs shared by all ShadingPrograms with identical code,
+// indexed by hash of the code and deleted when not used anymore.
+// If supported by the driver, binaries of programs are saved in
+// the settings path to avoid compiling again at next run.
+//
+struct ProgramCache
+{
+    struct Program {
+        unsigned int id;
+        int refcount;
+        std::unordered_map<std::string, int> locations;
+    };
+
+    std::map<size_t, Program> programs_;
+
+    static ProgramCache& instance()
+    {
+        static ProgramCache _instance;
+        return _instance;
+    }
+
+    // get the program with given key, false if not compiled
+    bool acquire(size_t key, unsigned int &id, std::unordered_map<std::string, int> &locations);
+    // share the program compiled with given key
+    void add(size_t key, unsigned int id, const std::unordered_map<std::string, int> &locations);
+    // stop using the program with given key
+    void release(size_t key);
+
+    // persistent binary of programs
+    static bool binarySupported();
+    unsigned int load(size_t key);
+    void save(size_t key, unsigned int id);
+
+private:
+    static std::string filename(size_t key);
+};
+
+bool ProgramCache::acquire(size_t key, unsigned int &id, std::unordered_map<std::string, int> &locations)
+{
+    auto p = programs_.find(key);
+    if (p == programs_.end())
+        return false;
+
+    p->second.refcount++;
+    id = p->second.id;
+    locations = p->second.locations;
+    return true;
+}
+
+void ProgramCache::add(size_t key, unsigned int id, const std::unordered_map<std::string, int> &locations)
+{
+    Program p;
+    p.id = id;
+    p.refcount = 1;
+    p.locations = locations;
+    programs_[key] = p;
+}
+
+void ProgramCache::release(size_t key)
+{
+    auto p = programs_.find(key);
+    if (p == programs_.end())
+        return;
+
+    // last user of the program
+    if ( --p->second.refcount < 1 ) {
+#ifdef SHADER_DEBUG
+        g_printerr("Delete GLSL Program %d \n", p->second.id);
+#endif
+        glDeleteProgram(p->second.id);
+        programs_.erase(p);
+    }
+}
+
+bool ProgramCache::binarySupported()
+{
+    static int formats = -1;
+    if (formats < 0) {
+        formats = 0;
+        if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    return formats > 0 && Settings::application.render.program_cache;
+}
+
+std::string ProgramCache::filename(size_t key)
+{
+    // binaries are only valid for the same driver
+    static std::string driver;
+    if (driver.empty()) {
+        const GLubyte *vendor = glGetString(GL_VENDOR);
+        const GLubyte *renderer = glGetString(GL_RENDERER);
+        const GLubyte *version = glGetString(GL_VERSION);
+        driver = std::string(vendor ? (const char *) vendor : "") + std::string(renderer ? (const char *) renderer : "")
+                + std::string(version ? (const char *) version : "");
+    }
+
+    std::ostringstream name;
+    name << std::hex << std::hash<std::string>{}(driver + std::to_string(key)) << ".bin";
+
+    return SystemToolkit::full_filename(SystemToolkit::full_filename(SystemToolkit::settings_path(), PROGRAM_CACHE_PATH), name.str());
+}
+
+unsigned int ProgramCache::load(size_t key)
+{
+    if (!binarySupported())
+        return 0;
+
+    std::ifstream file(filename(key), std::ios::binary);
+    if (!file.is_open())
+        return 0;
+
+    // file is the format followed by the binary
+    GLenum format = 0;
+    file.read(reinterpret_cast<char *>(&format), sizeof(format));
+    std::vector<char> binary( (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>() );
+    if (!file.good() && !file.eof())
+        return 0;
+    if (binary.empty())
+        return 0;
+
+    unsigned int id = glCreateProgram();
+    glProgramBinary(id, format, binary.data(), (GLsizei) binary.size());
+
+    // the driver can reject binaries (e.g. after update)
+    int success = GL_FALSE;
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(id);
+        std::remove( filename(key).c_str() );
+        return 0;
+    }
+
+    return id;
+}
+
+void ProgramCache::save(size_t key, unsigned int id)
+{
+    if (!binarySupported())
+        return;
+
+    int length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length < 1)
+        return;
+
+    GLenum format = 0;
+    std::vector<char> binary(length);
+    glGetProgramBinary(id, length, NULL, &format, binary.data());
+
+    // make sure the folder exists
+    const std::string folder = SystemToolkit::full_filename(SystemToolkit::settings_path(), PROGRAM_CACHE_PATH);
+    if ( !SystemToolkit::file_exists(folder) && !SystemToolkit::create_directory(folder) )
+        return;
+
+    std::ofstream file(filename(key), std::ios::binary | std::ios::trunc);
+    if (file.is_open()) {
+        file.write(reinterpret_cast<const char *>(&format), sizeof(format));
+        file.write(binary.data(), length);
+    }
+}
+
 ShadingProgram::ShadingProgram(const std::string& vertex, const std::string& fragment) :
-    id_(0), need_compile_(true), lineshift_(0), vertex_(vertex), fragment_(fragment), promise_(nullptr)
+    id_(0), key_(0), need_compile_(true), lineshift_(0), vertex_(vertex), fragment_(fragment), promise_(nullptr)
 {
 }
 
@@ -85,11 +260,160 @@ void ShadingProgram::setShaders(const std::string& vertex, const std::string& fr
 {
     vertex_ = vertex;
     fragment_ = fragment;
+    compute_.clear();
+    lineshift_ = lineshift;
+    promise_ = prom;
+    need_compile_ = true;
+}
+
+void ShadingProgram::setComputeShader(const std::string& compute, int lineshift,  std::promise<std::string> *prom)
+{
+    vertex_.clear();
+    fragment_.clear();
+    compute_ = compute;
     lineshift_ = lineshift;
     promise_ = prom;
     need_compile_ = true;
 }
 
+bool ShadingProgram::computeSupported()
+{
+    // context is created for 3.3 core, but drivers usually give more
+    return GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_compute_shader;
+}
+
+unsigned int ShadingProgram::link(const std::string& vertex_code, const std::string& fragment_code, char *infoLog)
+{
+    unsigned int id = 0;
+    int success = GL_FALSE;
+
+    // VERTEX SHADER
+    const char* vcode = vertex_code.c_str();
+    unsigned int vertex_id_ = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex_id_, 1, &vcode, NULL);
+    glCompileShader(vertex_id_);
+
+    glGetShaderiv(vertex_id_, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertex_id_, 1024, NULL, infoLog);
+        glDeleteShader(vertex_id_);
+        return 0;
+    }
+
+    // FRAGMENT SHADER
+    const char* fcode = fragment_code.c_str();
+    unsigned int fragment_id_ = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment_id_, 1, &fcode, NULL);
+    glCompileShader(fragment_id_);
+
+    glGetShaderiv(fragment_id_, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragment_id_, 1024, NULL, infoLog);
+        glDeleteShader(vertex_id_);
+        glDeleteShader(fragment_id_);
+        return 0;
+    }
+
+    // LINK PROGRAM
+    id = glCreateProgram();
+    // allow saving binary of program
+    if (ProgramCache::binarySupported())
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // attach shaders and link
+    glAttachShader(id, vertex_id_);
+    glAttachShader(id, fragment_id_);
+    glLinkProgram(id);
+
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(id, 1024, NULL, infoLog);
+        glDeleteProgram(id);
+        id = 0;
+    }
+
+    // done (no more need for shaders)
+    glDeleteShader(vertex_id_);
+    glDeleteShader(fragment_id_);
+
+    return id;
+}
+
+unsigned int ShadingProgram::link(const std::string& compute_code, char *infoLog)
+{
+    unsigned int id = 0;
+    int success = GL_FALSE;
+
+    // COMPUTE SHADER
+    const char* ccode = compute_code.c_str();
+    unsigned int compute_id_ = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(compute_id_, 1, &ccode, NULL);
+    glCompileShader(compute_id_);
+
+    glGetShaderiv(compute_id_, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(compute_id_, 1024, NULL, infoLog);
+        glDeleteShader(compute_id_);
+        return 0;
+    }
+
+    // LINK PROGRAM
+    id = glCreateProgram();
+    // allow saving binary of program
+    if (ProgramCache::binarySupported())
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    glAttachShader(id, compute_id_);
+    glLinkProgram(id);
+
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(id, 1024, NULL, infoLog);
+        glDeleteProgram(id);
+        id = 0;
+    }
+
+    // done (no more need for shader)
+    glDeleteShader(compute_id_);
+
+    return id;
+}
+
+void ShadingProgram::introspect()
+{
+    // keep locations of active uniforms
+    locations_.clear();
+    int count = 0;
+    glGetProgramiv(id_, GL_ACTIVE_UNIFORMS, &count);
+    for (int i = 0; i < count; ++i) {
+        char name[256];
+        GLsizei len = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(id_, (GLuint) i, sizeof(name), &len, &size, &type, name);
+        // members of uniform blocks have no location
+        GLint loc = glGetUniformLocation(id_, name);
+        if (loc < 0)
+            continue;
+        // arrays are named 'name[0]'
+        std::string n(name, len);
+        if ( n.size() > 3 && n.compare(n.size() - 3, 3, "[0]") == 0 )
+            n.resize(n.size() - 3);
+        locations_[n] = loc;
+    }
+
+    // use shared uniform block of matrices
+    GLuint block = glGetUniformBlockIndex(id_, MATRICES_BLOCK_NAME);
+    if (block != GL_INVALID_INDEX)
+        glUniformBlockBinding(id_, block, MATRICES_BINDING);
+
+    // set default uniforms
+    glUseProgram(id_);
+    glUniform1i(location("iChannel0"), 0);
+    glUniform1i(location("iChannel1"), 1);
+    glUseProgram(0);
+}
+
 void ShadingProgram::compile()
 {
     char infoLog[1024];
@@ -103,61 +427,38 @@ void ShadingProgram::compile()
     if (Resource::hasPath(fragment_))
         fragment_code = Resource::getText(fragment_);
 
-    // VERTEX SHADER
-    const char* vcode = vertex_code.c_str();
-    unsigned int vertex_id_ = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_id_, 1, &vcode, NULL);
-    glCompileShader(vertex_id_);
+    // release previous GL Program
+    release();
 
-    glGetShaderiv(vertex_id_, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex_id_, 1024, NULL, infoLog);
+    // cannot compile compute shader without support
+    if ( !compute_.empty() && !computeSupported() ) {
+        if (promise_)
+            promise_->set_value( "Error\nCompute shaders are not supported." );
+        need_compile_ = false;
+        return;
     }
+
+    // identical code compiled by another ShadingProgram
+    key_ = std::hash<std::string>{}(vertex_code + fragment_code + compute_);
+    if ( ProgramCache::instance().acquire(key_, id_, locations_) )
+        success = GL_TRUE;
     else {
-        // FRAGMENT SHADER
-        const char* fcode = fragment_code.c_str();
-        unsigned int fragment_id_ = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment_id_, 1, &fcode, NULL);
-        glCompileShader(fragment_id_);
-
-        glGetShaderiv(fragment_id_, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragment_id_, 1024, NULL, infoLog);
-            glDeleteShader(vertex_id_);
+        // binary of program compiled in a previous run, or compile now
+        id_ = ProgramCache::instance().load(key_);
+        if (id_ == 0) {
+            id_ = compute_.empty() ? link(vertex_code, fragment_code, infoLog) : link(compute_, infoLog);
+            if (id_ != 0)
+                ProgramCache::instance().save(key_, id_);
         }
-        else {
-            // LINK PROGRAM
 
-            // create new GL Program
-            if (id_ != 0)
-                glDeleteProgram(id_);
-            id_ = glCreateProgram();
-
-            // attach shaders and link
-            glAttachShader(id_, vertex_id_);
-            glAttachShader(id_, fragment_id_);
-            glLinkProgram(id_);
-
-            glGetProgramiv(id_, GL_LINK_STATUS, &success);
-            if (!success) {
-                glGetProgramInfoLog(id_, 1024, NULL, infoLog);
-                glDeleteProgram(id_);
-                id_ = 0;
-            }
-            else {
-                // all good, set default uniforms
-                glUseProgram(id_);
-                glUniform1i(glGetUniformLocation(id_, "iChannel0"), 0);
-                glUniform1i(glGetUniformLocation(id_, "iChannel1"), 1);
+        if (id_ != 0) {
+            // all good, share the new program
+            success = GL_TRUE;
+            introspect();
+            ProgramCache::instance().add(key_, id_, locations_);
 #ifdef SHADER_DEBUG
-                g_printerr("New GLSL Program %d \n", id_);
+            g_printerr("New GLSL Program %d \n", id_);
 #endif
-            }
-
-            // done (no more need for shaders)
-            glUseProgram(0);
-            glDeleteShader(vertex_id_);
-            glDeleteShader(fragment_id_);
         }
     }
 
@@ -193,7 +494,7 @@ void ShadingProgram::compile()
         promise_->set_value( success ? "Ok" : "Error\n" + message );
     // if not asked to return a promise, inform user through logs
     else if (!success)
-        Log::Warning("Error compiling Vertex ShadingProgram:\n%s", message.c_str());
+        Log::Warning("Error compiling %s ShadingProgram:\n%s", compute_.empty() ? "Vertex" : "Compute", message.c_str());
 
     // do not compile indefinitely
     need_compile_ = false;
@@ -217,67 +518,109 @@ void ShadingProgram::enduse()
 {
     glUseProgram(0);
     currentProgram_ = nullptr ;
+    // binding of buffers is not shared between gl contexts
+    matrices_bound_ = false;
 }
 
-void ShadingProgram::reset()
+void ShadingProgram::setMatrices(const glm::mat4 &projection, const glm::mat4 &modelview)
+{
+    static glm::mat4 matrices[2];
+
+    // create uniform buffer object once
+    if (matrices_buffer_ == 0) {
+        glGenBuffers(1, &matrices_buffer_);
+        glBindBuffer(GL_UNIFORM_BUFFER, matrices_buffer_);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(matrices), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    // nothing changed
+    else if (matrices_bound_ && matrices[0] == projection && matrices[1] == modelview)
+        return;
+
+    // bind buffer to the binding point of the block
+    if (!matrices_bound_) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, MATRICES_BINDING, matrices_buffer_);
+        matrices_bound_ = true;
+    }
+
+    // update content of buffer (std140 layout of two mat4)
+    matrices[0] = projection;
+    matrices[1] = modelview;
+    glBindBuffer(GL_UNIFORM_BUFFER, matrices_buffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(matrices), glm::value_ptr(matrices[0]));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+int ShadingProgram::location(const std::string& name) const
+{
+    // inactive or unknown uniforms are ignored by glUniform (location -1)
+    auto loc = locations_.find(name);
+    return loc != locations_.end() ? loc->second : -1;
+}
+
+void ShadingProgram::release()
 {
     if (id_ != 0) {
-#ifdef SHADER_DEBUG
-        g_printerr("Delete GLSL Program %d \n", id_);
-#endif
-        glDeleteProgram(id_);
+        // GL Program is deleted if not used by other ShadingPrograms
+        ProgramCache::instance().release(key_);
         id_ = 0;
+        locations_.clear();
     }
+}
+
+void ShadingProgram::reset()
+{
+    release();
     ShadingProgram::enduse();
 }
 
 template<>
 void ShadingProgram::setUniform<int>(const std::string& name, int val) {
-	glUniform1i(glGetUniformLocation(id_, name.c_str()), val);
+	glUniform1i(location(name), val);
 }
 
 template<>
 void ShadingProgram::setUniform<bool>(const std::string& name, bool val) {
-	glUniform1i(glGetUniformLocation(id_, name.c_str()), val);
+	glUniform1i(location(name), val);
 }
 
 template<>
 void ShadingProgram::setUniform<float>(const std::string& name, float val) {
-	glUniform1f(glGetUniformLocation(id_, name.c_str()), val);
+	glUniform1f(location(name), val);
 }
 
 template<>
 void ShadingProgram::setUniform<float>(const std::string& name, float val1, float val2) {
-    glUniform2f(glGetUniformLocation(id_, name.c_str()), val1, val2);
+    glUniform2f(location(name), val1, val2);
 }
 
 template<>
 void ShadingProgram::setUniform<float>(const std::string& name, float val1, float val2, float val3) {
-    glUniform3f(glGetUniformLocation(id_, name.c_str()), val1, val2, val3);
+    glUniform3f(location(name), val1, val2, val3);
 }
 
 template<>
 void ShadingProgram::setUniform<glm::vec2>(const std::string& name, glm::vec2 val) {
     glm::vec2 v(val);
-    glUniform2fv(glGetUniformLocation(id_, name.c_str()), 1, glm::value_ptr(v));
+    glUniform2fv(location(name), 1, glm::value_ptr(v));
 }
 
 template<>
 void ShadingProgram::setUniform<glm::vec3>(const std::string& name, glm::vec3 val) {
     glm::vec3 v(val);
-    glUniform3fv(glGetUniformLocation(id_, name.c_str()), 1, glm::value_ptr(v));
+    glUniform3fv(location(name), 1, glm::value_ptr(v));
 }
 
 template<>
 void ShadingProgram::setUniform<glm::vec4>(const std::string& name, glm::vec4 val) {
     glm::vec4 v(val);
-    glUniform4fv(glGetUniformLocation(id_, name.c_str()), 1, glm::value_ptr(v));
+    glUniform4fv(location(name), 1, glm::value_ptr(v));
 }
 
 template<>
 void ShadingProgram::setUniform<glm::mat4>(const std::string& name, glm::mat4 val) {
     glm::mat4 m(val);
-	glUniformMatrix4fv(glGetUniformLocation(id_, name.c_str()), 1, GL_FALSE, glm::value_ptr(m));
+	glUniformMatrix4fv(location(name), 1, GL_FALSE, glm::value_ptr(m));
 }
 
 
@@ -316,8 +659,7 @@ void Shader::use()
     program_->use();
 
     // set uniforms
-    program_->setUniform("projection", projection);
-    program_->setUniform("modelview", modelview);
+    ShadingProgram::setMatrices(projection, modelview);
     program_->setUniform("iTransform", iTransform);
     program_->setUniform("color", color);
 
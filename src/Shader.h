@@ -4,6 +4,7 @@
 #include <future>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <glm/glm.hpp>
 
 // Forward declare classes referenced
@@ -19,25 +20,47 @@ public:
     // Update GLSL Program with vertex and fragment program
     // If a promise is given, it is filled during compilation with the compilation log.
     void setShaders(const std::string& vertex, const std::string& fragment, int lineshift = 0, std::promise<std::string> *prom = nullptr);
+    // Update GLSL Program with a compute shader (replaces vertex and fragment)
+    void setComputeShader(const std::string& compute, int lineshift = 0, std::promise<std::string> *prom = nullptr);
+    // true if the compute shaders are supported (OpenGL 4.3)
+    static bool computeSupported();
 
     void use();
     void compile();
     static void enduse();
     void reset();
+    inline bool linked() const { return id_ != 0; }
 
 	template<typename T> void setUniform(const std::string& name, T val);
 	template<typename T> void setUniform(const std::string& name, T val1, T val2);
     template<typename T> void setUniform(const std::string& name, T val1, T val2, T val3);
 
+    // set the transformation matrices of the uniform block shared by all programs
+    static void setMatrices(const glm::mat4 &projection, const glm::mat4 &modelview);
+
 private:
     unsigned int id_;
     bool need_compile_;
     int lineshift_;
     std::string vertex_;
     std::string fragment_;
+    std::string compute_;
     std::promise<std::string> *promise_;
 
+    // locations of active uniforms, filled after linking
+    std::unordered_map<std::string, int> locations_;
+    int location(const std::string& name) const;
+
+    // GL Programs are shared by code (key is hash of code)
+    size_t key_;
+    static unsigned int link(const std::string& vertex_code, const std::string& fragment_code, char *infoLog);
+    static unsigned int link(const std::string& compute_code, char *infoLog);
+    void introspect();
+    void release();
+
     static ShadingProgram *currentProgram_;
+    static unsigned int matrices_buffer_;
+    static bool matrices_bound_;
 };
 
 class Shader
@@ -28,6 +28,7 @@
 #include "Decorations.h"
 #include "Resource.h"
 #include "SearchVisitor.h"
+#include "BoundingBoxVisitor.h"
 #include "ImageShader.h"
 #include "ImageProcessingShader.h"
 #include "BaseToolkit.h"
@@ -115,8 +116,8 @@ SourceCore& SourceCore::operator= (SourceCore const& other)
 }
 
 
-Source::Source(uint64_t id) : SourceCore(), id_(id), ready_(false), symbol_(nullptr),
-    active_(true), locked_(false), need_update_(true), dt_(16.f), workspace_(STAGE)
+Source::Source(uint64_t id) : SourceCore(), id_(id), ready_(false), need_render_(true), symbol_(nullptr),
+    active_(true), locked_(false), need_update_(true), dt_(16.f), hidden_time_(0.f), workspace_(STAGE)
 {
     // create unique id
     if (id_ == 0)
@@ -311,6 +312,13 @@ Source::Source(uint64_t id) : SourceCore(), id_(id), ready_(false), symbol_(null
     // - additional custom shader can be associated
     texturesurface_ = new Surface(renderingshader_);
 
+    // state of inputs at last render
+    rendered_.texture = 0;
+    rendered_.color = glm::vec4(1.f);
+    rendered_.iTransform = glm::identity<glm::mat4>();
+    rendered_.processing = false;
+    rendered_processing_ = new ImageProcessingShader;
+
     // will be created at init
     renderbuffer_   = nullptr;
     rendersurface_  = nullptr;
@@ -344,6 +352,7 @@ Source::~Source()
         delete masksurface_; // deletes maskshader_
 
     delete texturesurface_;
+    delete rendered_processing_;
 
     overlays_.clear();
     frames_.clear();
@@ -468,7 +477,7 @@ void Source::render()
 {
     if ( renderbuffer_ == nullptr )
         init();
-    else {
+    else if ( renderNeeded() ) {
         // render the view into frame buffer
         renderbuffer_->begin();
         texturesurface_->draw(glm::identity<glm::mat4>(), renderbuffer_->projection());
@@ -477,6 +486,37 @@ void Source::render()
     }
 }
 
+bool Source::renderNeeded()
+{
+    // always ask subclass (to keep track of its texture)
+    bool need = textureChanged();
+
+    // change of texture or of shader parameters
+    Shader *s = texturesurface_->shader();
+    if ( rendered_.texture != texturesurface_->textureIndex() ||
+         rendered_.color != s->color ||
+         rendered_.iTransform != s->iTransform ||
+         rendered_.processing != imageProcessingEnabled() ) {
+        rendered_.texture = texturesurface_->textureIndex();
+        rendered_.color = s->color;
+        rendered_.iTransform = s->iTransform;
+        rendered_.processing = imageProcessingEnabled();
+        need = true;
+    }
+
+    // change of image processing
+    if ( rendered_.processing && !rendered_processing_->equals(*processingshader_) ) {
+        rendered_processing_->copy(*processingshader_);
+        need = true;
+    }
+
+    // forced (e.g. crop or new renderbuffer)
+    need |= need_render_;
+    need_render_ = false;
+
+    return need;
+}
+
 void Source::attach(FrameBuffer *renderbuffer)
 {
     // invalid argument
@@ -487,6 +527,7 @@ void Source::attach(FrameBuffer *renderbuffer)
     if (renderbuffer_)
         delete renderbuffer_;
     renderbuffer_ = renderbuffer;
+    need_render_ = true;
 
     // create rendersurface_ only once
     if ( rendersurface_ == nullptr) {
@@ -719,6 +760,35 @@ void Source::updateCallbacks(float dt)
     access_callbacks_.unlock();
 }
 
+void Source::updateVisibility(const GlmToolkit::AxisAlignedBoundingBox &area)
+{
+    bool v = false;
+
+    // inactive sources are not displayed
+    if ( active_ && renderbuffer_ ) {
+
+        // not transparent, not cropped out
+        const glm::vec3 crop = groups_[View::GEOMETRY]->crop_;
+        if ( blendingshader_->color.a > 0.f && crop.x > 0.f && crop.y > 0.f ) {
+            // surface in the area of the frame
+            BoundingBoxVisitor bbox;
+            groups_[View::RENDERING]->accept(bbox);
+            v = area.intersect( bbox.bbox() );
+        }
+
+        // rendered by a visible clone
+        for (auto clone = clones_.begin(); !v && clone != clones_.end(); ++clone)
+            v = (*clone)->visible();
+    }
+
+    // visible immediately, hidden after delay
+    // (avoids stopping rendering while moving around)
+    if (v)
+        hidden_time_ = 0.f;
+    else if ( hidden_time_ < SOURCE_HIDING_DELAY )
+        hidden_time_ += dt_;
+}
+
 CloneSource *Source::clone(uint64_t id)
 {
     CloneSource *s = new CloneSource(this, id);
@@ -767,6 +837,7 @@ void Source::update(float dt)
 
             // MODIFY CROP projection based on GEOMETRY crop
             renderbuffer_->setProjectionArea( glm::vec2(groups_[View::GEOMETRY]->crop_) );
+            need_render_ = true;
 
             // Mixing and layer icons scaled based on GEOMETRY crop
             mixingsurface_->scale_ = groups_[View::GEOMETRY]->crop_;
@@ -12,6 +12,7 @@
 #include "View.h"
 
 #define DEFAULT_MIXING_TRANSLATION -1.f, 1.f
+#define SOURCE_HIDING_DELAY 500.f
 
 #define ICON_SOURCE_VIDEO 18, 13
 #define ICON_SOURCE_IMAGE 4, 9
@@ -145,6 +146,12 @@ public:
     // informs if its ready (i.e. initialized)
     inline bool ready () const  { return ready_; }
 
+    // a source is visible if it contributes to the output frame, i.e.
+    // if active, not transparent and inside the area of the frame,
+    // or if a clone of it is visible. NB: hiding is delayed.
+    void updateVisibility (const GlmToolkit::AxisAlignedBoundingBox &area);
+    inline bool visible () const { return hidden_time_ < SOURCE_HIDING_DELAY; }
+
     // a Source shall be updated before displayed (Mixing, Geometry and Layer)
     virtual void update (float dt);
 
@@ -283,6 +290,20 @@ protected:
     FrameBuffer *renderbuffer_;
     void attach(FrameBuffer *renderbuffer);
 
+    // render() skips drawing into the renderbuffer if nothing changed
+    // since last draw (texture content, texture, shader, crop)
+    bool need_render_;
+    bool renderNeeded ();
+    // subclasses tell if the content of their texture changed since last call
+    virtual bool textureChanged () { return true; }
+    struct {
+        uint texture;
+        glm::vec4 color;
+        glm::mat4 iTransform;
+        bool processing;
+    } rendered_;
+    ImageProcessingShader *rendered_processing_;
+
     // the rendersurface draws the renderbuffer in the scene
     // It is associated to the rendershader for mixing effects
     FrameBufferSurface *rendersurface_;
@@ -323,6 +344,7 @@ protected:
     bool  locked_;
     bool  need_update_;
     float dt_;
+    float hidden_time_;
     Workspace  workspace_;
 
     // callbacks
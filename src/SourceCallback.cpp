@@ -22,6 +22,8 @@
 #include "ImageProcessingShader.h"
 #include "MediaSource.h"
 #include "MediaPlayer.h"
+#include "CloneSource.h"
+#include "DelayFilter.h"
 #include "Visitor.h"
 
 #include "SourceCallback.h"
@@ -543,6 +545,12 @@ float PlaySpeed::readValue(Source *s) const
     if (ms != nullptr) {
         ret = (float) ms->mediaplayer()->playSpeed();
     }
+    // access time machine if target source is a clone with this filter
+    else if (CloneSource *cs = dynamic_cast<CloneSource *>(s)) {
+        TimeMachineFilter *tm = dynamic_cast<TimeMachineFilter *>(cs->filter());
+        if (tm != nullptr)
+            ret = tm->speed();
+    }
 
     return (float)ret;
 }
@@ -554,6 +562,12 @@ void PlaySpeed::writeValue(Source *s, float val)
     if (ms != nullptr) {
         ms->mediaplayer()->setPlaySpeed((double) val);
     }
+    // access time machine if target source is a clone with this filter
+    else if (CloneSource *cs = dynamic_cast<CloneSource *>(s)) {
+        TimeMachineFilter *tm = dynamic_cast<TimeMachineFilter *>(cs->filter());
+        if (tm != nullptr)
+            tm->setSpeed((double) val);
+    }
 }
 
 PlayFastForward::PlayFastForward(uint seekstep, float ms) : SourceCallback(), media_(nullptr),
@@ -631,6 +645,12 @@ float Seek::readValue(Source *s) const
             ret = GST_TIME_AS_SECONDS( static_cast<double>(media_position) );
         }
     }
+    // position in history (second before live) of a time machine
+    else if (CloneSource *cs = dynamic_cast<CloneSource *>(s)) {
+        TimeMachineFilter *tm = dynamic_cast<TimeMachineFilter *>(cs->filter());
+        if (tm != nullptr)
+            ret = tm->position();
+    }
 
     return (float) ret;
 }
@@ -647,6 +667,12 @@ void Seek::writeValue(Source *s, float val)
                 t < media_duration )
             ms->mediaplayer()->seek( t );
     }
+    // position in history (second before live) of a time machine
+    else if (CloneSource *cs = dynamic_cast<CloneSource *>(s)) {
+        TimeMachineFilter *tm = dynamic_cast<TimeMachineFilter *>(cs->filter());
+        if (tm != nullptr)
+            tm->setPosition((double) val);
+    }
 }
 
 SetGeometry::SetGeometry(const Group *g, float ms, bool revert) : SourceCallback(),
@@ -36,7 +36,7 @@
 #endif
 
 
-Stream::Stream()
+Stream::Stream() : frame_queue_(N_FRAME)
 {
     // create unique id
     id_ = BaseToolkit::uniqueId();
@@ -55,10 +55,6 @@ Stream::Stream()
     failed_ = false;
     decoder_name_ = "";
 
-    // start index in frame_ stack
-    write_index_ = 0;
-    last_index_ = 0;
-
     // no PBO by default
     pbo_[0] = pbo_[1] = 0;
     pbo_size_ = 0;
@@ -67,6 +63,7 @@ Stream::Stream()
 
     // OpenGL texture
     textureindex_ = 0;
+    frame_count_ = 0;
     textureinitialized_ = false;
 }
 
@@ -337,13 +334,6 @@ bool Stream::failed() const
     return failed_;
 }
 
-void Stream::Frame::unmap()
-{
-    if ( full )
-        gst_video_frame_unmap(&vframe);
-    full = false;
-}
-
 void Stream::close()
 {
     // not opened?
@@ -374,13 +364,7 @@ void Stream::close()
     }
 
     // cleanup eventual remaining frame memory
-    for(guint i = 0; i < N_FRAME; ++i){
-        frame_[i].access.lock();
-        frame_[i].unmap();
-        frame_[i].access.unlock();
-    }
-    write_index_ = 0;
-    last_index_ = 0;
+    frame_queue_.clear();
 
 }
 
@@ -515,7 +499,7 @@ GstClockTime Stream::position()
     return position_;
 }
 
-void Stream::init_texture(guint index)
+void Stream::init_texture(GstVideoFrame *frame)
 {
     glActiveTexture(GL_TEXTURE0);
     if (textureindex_)
@@ -524,7 +508,7 @@ void Stream::init_texture(guint index)
     glBindTexture(GL_TEXTURE_2D, textureindex_);
     glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width_, height_);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_,
-                    GL_RGBA, GL_UNSIGNED_BYTE, frame_[index].vframe.data[0]);
+                    GL_RGBA, GL_UNSIGNED_BYTE, frame->data[0]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -549,7 +533,7 @@ void Stream::init_texture(guint index)
             GLubyte* ptr = (GLubyte*) glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
             if (ptr)  {
                 // update data directly on the mapped buffer
-                memmove(ptr, frame_[index].vframe.data[0], pbo_size_);
+                memmove(ptr, frame->data[0], pbo_size_);
                 // release pointer to mapping buffer
                 glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
             }
@@ -580,13 +564,16 @@ void Stream::init_texture(guint index)
 }
 
 
-void Stream::fill_texture(guint index)
+void Stream::fill_texture(GstVideoFrame *frame)
 {
+    // new content in texture
+    ++frame_count_;
+
     // is this the first frame ?
     if ( !textureinitialized_ || !textureindex_)
     {
         // initialize texture
-        init_texture(index);
+        init_texture(frame);
     }
 
     glBindTexture(GL_TEXTURE_2D, textureindex_);
@@ -604,7 +591,7 @@ void Stream::fill_texture(guint index)
         // bind the next PBO to write pixels
         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[pbo_next_index_]);
 #ifdef USE_GL_BUFFER_SUBDATA
-            glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, pbo_size_, frame_[index].vframe.data[0]);
+            glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, pbo_size_, frame->data[0]);
 #else
             // update data directly on the mapped buffer
             // NB : equivalent but faster than glBufferSubData (memmove instead of memcpy ?)
@@ -613,7 +600,7 @@ void Stream::fill_texture(guint index)
             // map the buffer object into client's memory
             GLubyte* ptr = (GLubyte*) glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
             if (ptr) {
-                memmove(ptr, frame_[index].vframe.data[0], pbo_size_);
+                memmove(ptr, frame->data[0], pbo_size_);
                 // release pointer to mapping buffer
                 glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
             }
@@ -624,7 +611,7 @@ void Stream::fill_texture(guint index)
     else {
         // without PBO, use standard opengl (slower)
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_,
-                        GL_RGBA, GL_UNSIGNED_BYTE, frame_[index].vframe.data[0]);
+                        GL_RGBA, GL_UNSIGNED_BYTE, frame->data[0]);
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -665,59 +652,39 @@ void Stream::update()
         return;
 
     // local variables before trying to update
-    guint read_index = 0;
     bool need_loop = false;
 
-    // locked access to current index
-    index_lock_.lock();
-    // get the last frame filled from fill_frame()
-    read_index = last_index_;
-    // Do NOT miss and jump directly to a pre-roll
-    for (guint i = 0; i < N_FRAME; ++i) {
-        if (frame_[i].status == PREROLL) {
-            read_index = i;
-            break;
-        }
-    }
-    // unlock access to index change
-    index_lock_.unlock();
-
-    // lock frame while reading it
-    frame_[read_index].access.lock();
+    // get the last frame filled from fill_frame() (never blocks)
+    // NB: the queue does NOT miss and jumps directly to a pre-roll
+    FrameQueue::Frame *frame = frame_queue_.readFrame();
 
     // do not fill a frame twice
-    if (frame_[read_index].status != INVALID ) {
+    if (frame != nullptr) {
 
         // is this an End-of-Stream frame ?
-        if (frame_[read_index].status == EOS )
+        if (frame->status == FrameQueue::EOS )
         {
-            // will execute seek command below (after unlock)
+            // will execute seek command below (after release)
             need_loop = true;
         }
         // otherwise just fill non-empty SAMPLE or PREROLL
-        else if (frame_[read_index].full)
+        else if (frame->full)
         {
-            // fill the texture with the frame at reading index
-            fill_texture(read_index);
+            // fill the texture with the frame read
+            fill_texture(&frame->vframe);
 
             // double update for pre-roll frame and dual PBO (ensure frame is displayed now)
-            if (frame_[read_index].status == PREROLL && pbo_size_ > 0)
-                fill_texture(read_index);
-
-            // free frame
-            frame_[read_index].unmap();
+            if (frame->status == FrameQueue::PREROLL && pbo_size_ > 0)
+                fill_texture(&frame->vframe);
         }
 
         // we just displayed a vframe : set position time to frame PTS
-        position_ = frame_[read_index].position;
+        position_ = frame->position;
 
-        // avoid reading it again
-        frame_[read_index].status = INVALID;
+        // free frame and give it back to fill_frame()
+        frame_queue_.pop();
     }
 
-    // unkock frame after reading it
-    frame_[read_index].access.unlock();
-
     if (need_loop) {
         // stop on end of stream
         play(false);
@@ -732,75 +699,61 @@ double Stream::updateFrameRate() const
 
 // CALLBACKS
 
-bool Stream::fill_frame(GstBuffer *buf, FrameStatus status)
+bool Stream::fill_frame(GstBuffer *buf, FrameQueue::FrameStatus status)
 {
 //    Log::Info("Stream fill frame");
 
-    // Do NOT overwrite an unread EOS
-    if ( frame_[write_index_].status == EOS )
-        write_index_ = (write_index_ + 1) % N_FRAME;
+    // null buffer for EOS
+    if (buf == NULL) {
+        frame_queue_.pushEndOfStream();
+#ifdef STREAM_DEBUG
+        Log::Info("Stream %s Reached End Of Stream", std::to_string(id_).c_str());
+#endif
+        return true;
+    }
 
-    // lock access to frame
-    frame_[write_index_].access.lock();
+    // get a free frame to write (no lock)
+    FrameQueue::Frame *frame = frame_queue_.writeFrame(status);
 
-    // always empty frame before filling it again
-    frame_[write_index_].unmap();
+    // all frames are still to be displayed: drop this one
+    if (frame == nullptr)
+        return true;
 
     // accept status of frame received
-    frame_[write_index_].status = status;
+    frame->status = status;
 
-    // a buffer is given (not EOS)
-    if (buf != NULL) {
-        // get the frame from buffer
-        if ( !gst_video_frame_map (&frame_[write_index_].vframe, &v_frame_video_info_, buf, GST_MAP_READ ) )
-        {
-            Log::Info("Stream %s Failed to map the video buffer", std::to_string(id_).c_str());
-            // free access to frame & exit
-            frame_[write_index_].status = INVALID;
-            frame_[write_index_].access.unlock();
-            return false;
-        }
+    // get the frame from buffer
+    if ( !gst_video_frame_map (&frame->vframe, &v_frame_video_info_, buf, GST_MAP_READ ) )
+    {
+        Log::Info("Stream %s Failed to map the video buffer", std::to_string(id_).c_str());
+        // do not publish frame & exit
+        frame->status = FrameQueue::INVALID;
+        return false;
+    }
 
-        // successfully filled the frame
-        frame_[write_index_].full = true;
+    // successfully filled the frame
+    frame->full = true;
 
-        // validate frame format
-        if( GST_VIDEO_INFO_IS_RGB(&(frame_[write_index_].vframe).info) && GST_VIDEO_INFO_N_PLANES(&(frame_[write_index_].vframe).info) == 1)
-        {
-            // set presentation time stamp
-            frame_[write_index_].position = buf->pts;
+    // validate frame format
+    if( GST_VIDEO_INFO_IS_RGB(&(frame->vframe).info) && GST_VIDEO_INFO_N_PLANES(&(frame->vframe).info) == 1)
+    {
+        // set presentation time stamp
+        frame->position = buf->pts;
 
-        }
-        // full but invalid frame : will be deleted next iteration
-        // (should never happen)
-        else {
-#ifdef STREAM_DEBUG
-            Log::Info("Stream %s Received an Invalid frame", std::to_string(id_).c_str());
-#endif
-            frame_[write_index_].status = INVALID;            
-            frame_[write_index_].access.unlock();
-            return false;
-        }
     }
-    // else; null buffer for EOS: give a position
+    // full but invalid frame : free it and do not publish
+    // (should never happen)
     else {
-        frame_[write_index_].status = EOS;
 #ifdef STREAM_DEBUG
-        Log::Info("Stream %s Reached End Of Stream", std::to_string(id_).c_str());
+        Log::Info("Stream %s Received an Invalid frame", std::to_string(id_).c_str());
 #endif
+        frame->unmap();
+        frame->status = FrameQueue::INVALID;
+        return false;
     }
 
-    // unlock access to frame
-    frame_[write_index_].access.unlock();
-
-    // lock access to change current index (very quick)
-    index_lock_.lock();
-    // indicate update() that this is the last frame filled (and unlocked)
-    last_index_ = write_index_;
-    // unlock access to index change
-    index_lock_.unlock();
-    // for writing, we will access the next in stack
-    write_index_ = (write_index_ + 1) % N_FRAME;
+    // indicate update() that this is the last frame filled
+    frame_queue_.push();
 
     // calculate actual FPS of update
     timecount_.tic();
@@ -812,7 +765,7 @@ void Stream::callback_end_of_stream (GstAppSink *, gpointer p)
 {
     Stream *m = static_cast<Stream *>(p);
     if (m && m->opened_) {
-        m->fill_frame(NULL, Stream::EOS);
+        m->fill_frame(NULL, FrameQueue::EOS);
     }
 }
 
@@ -833,7 +786,7 @@ GstFlowReturn Stream::callback_new_preroll (GstAppSink *sink, gpointer p)
             GstBuffer *buf = gst_sample_get_buffer (sample);
 
             // fill frame from buffer
-            if ( !m->fill_frame(buf, Stream::PREROLL) )
+            if ( !m->fill_frame(buf, FrameQueue::PREROLL) )
                 ret = GST_FLOW_ERROR;
         }
     }
@@ -867,7 +820,7 @@ GstFlowReturn Stream::callback_new_sample (GstAppSink *sink, gpointer p)
             GstBuffer *buf = gst_sample_get_buffer (sample) ;
 
             // fill frame with buffer
-            if ( !m->fill_frame(buf, Stream::SAMPLE) )
+            if ( !m->fill_frame(buf, FrameQueue::SAMPLE) )
                 ret = GST_FLOW_ERROR;
         }
     }
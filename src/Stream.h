@@ -11,6 +11,8 @@
 #include <gst/pbutils/pbutils.h>
 #include <gst/app/gstappsink.h>
 
+#include "FrameQueue.h"
+
 // Forward declare classes referenced
 class Visitor;
 
@@ -137,6 +139,11 @@ public:
      * Must be called in OpenGL context
      * */
     guint texture() const;
+    /**
+     * Get the number of frames filled in the texture
+     * (changes when the content of texture changes)
+     * */
+    inline uint64_t frameCount() const { return frame_count_; }
     /**
      * Get the name of the decoder used,
      * return 'software' if no hardware decoder is used
@@ -160,6 +167,7 @@ protected:
     uint64_t id_;
     std::string description_;
     guint textureindex_;
+    uint64_t frame_count_;
 
     // general properties of media
     guint width_;
@@ -191,31 +199,7 @@ protected:
     TimeCounter timecount_;
 
     // frame stack
-    typedef enum  {
-        SAMPLE = 0,
-        PREROLL = 1,
-        EOS = 2,
-        INVALID = 3
-    } FrameStatus;
-
-    struct Frame {
-        GstVideoFrame vframe;
-        FrameStatus status;
-        bool full;
-        GstClockTime position;
-        std::mutex access;
-
-        Frame() {
-            full = false;
-            status = INVALID;
-            position = GST_CLOCK_TIME_NONE;
-        }
-        void unmap();
-    };
-    Frame frame_[N_FRAME];
-    guint write_index_;
-    guint last_index_;
-    std::mutex index_lock_;
+    FrameQueue frame_queue_;
 
     // for PBO
     guint pbo_[2];
@@ -229,9 +213,9 @@ protected:
 
     // gst frame filling
     bool textureinitialized_;
-    void init_texture(guint index);
-    void fill_texture(guint index);
-    bool fill_frame(GstBuffer *buf, FrameStatus status);
+    void init_texture(GstVideoFrame *frame);
+    void fill_texture(GstVideoFrame *frame);
+    bool fill_frame(GstBuffer *buf, FrameQueue::FrameStatus status);
     std::condition_variable initialized_;
     static void timeout_initialize(Stream *str);
 
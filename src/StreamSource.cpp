@@ -82,7 +82,7 @@ std::string GenericStreamSource::info() const
     return "Custom gstreamer";
 }
 
-StreamSource::StreamSource(uint64_t id) : Source(id), stream_(nullptr)
+StreamSource::StreamSource(uint64_t id) : Source(id), stream_(nullptr), rendered_frame_(0)
 {
 }
 
@@ -106,6 +106,17 @@ uint StreamSource::texture() const
         return stream_->texture();
 }
 
+bool StreamSource::textureChanged()
+{
+    if (stream_ == nullptr)
+        return true;
+
+    uint64_t f = stream_->frameCount();
+    bool changed = ( f != rendered_frame_ );
+    rendered_frame_ = f;
+    return changed;
+}
+
 void StreamSource::init()
 {
     if ( stream_ && stream_->isOpen() ) {
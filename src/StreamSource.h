@@ -43,8 +43,10 @@ public:
 
 protected:
     void init() override;
+    bool textureChanged() override;
 
     Stream *stream_;
+    uint64_t rendered_frame_;
 };
 
 /**
@@ -290,6 +290,19 @@ bool SystemToolkit::file_exists(const string& path)
     // TODO : WIN32 implementation (see tinyfd)
 }
 
+bool SystemToolkit::file_status(const string& path, unsigned long long &size, long long &mtime)
+{
+    struct stat st;
+    if (path.empty() || stat(path.c_str(), &st) != 0)
+        return false;
+
+    size = static_cast<unsigned long long>(st.st_size);
+    mtime = static_cast<long long>(st.st_mtime);
+    return true;
+
+    // TODO : verify WIN32 implementation
+}
+
 
 // tests if dir is a directory and return its path, empty string otherwise
 string SystemToolkit::path_directory(const string& path)
@@ -67,6 +67,9 @@ namespace SystemToolkit
     // true of file exists
     bool file_exists(const std::string& path);
 
+    // get size (in bytes) and modification time of file, return false if cannot access it
+    bool file_status(const std::string& path, unsigned long long &size, long long &mtime);
+
     // create directory and return true on success
     bool create_directory(const std::string& path);
 
@@ -404,6 +404,32 @@ TimeIntervalSet Timeline::sections() const
     return sec;
 }
 
+bool Timeline::getSectionAt(const GstClockTime t, TimeInterval &section, bool forward) const
+{
+    TimeIntervalSet sec = sections();
+
+    // forward: first section ending after t (includes t, or follows the gap at t)
+    if (forward) {
+        for (auto it = sec.begin(); it != sec.end(); ++it) {
+            if ( t < (*it).end ) {
+                section = (*it);
+                return true;
+            }
+        }
+    }
+    // backward: last section starting before t
+    else {
+        for (auto it = sec.rbegin(); it != sec.rend(); ++it) {
+            if ( (*it).begin < t ) {
+                section = (*it);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 void Timeline::clearGaps()
 {
     gaps_.clear();
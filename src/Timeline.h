@@ -137,6 +137,7 @@ public:
 
     // inverse of gaps: sections of play areas
     TimeIntervalSet sections() const;
+    bool getSectionAt(const GstClockTime t, TimeInterval &section, bool forward = true) const;
     GstClockTime sectionsDuration() const;
     GstClockTime sectionsTimeAt(GstClockTime t) const;
     size_t fillSectionsArrays(float * const gaps, float * const fading);
@@ -77,6 +77,8 @@ using namespace std;
 #include "Selection.h"
 #include "FrameBuffer.h"
 #include "MediaPlayer.h"
+#include "FrameCache.h"
+#include "MediaProxy.h"
 #include "SourceCallback.h"
 #include "CloneSource.h"
 #include "MediaSource.h"
@@ -1303,8 +1305,15 @@ void UserInterface::RenderMetrics(bool *p_open, int* p_corner, int *p_mode)
         ImGui::PopFont();
         ImGui::SameLine(0, IMGUI_SAME_LINE);
         ImGui::Text("FPS");
-        if (ImGui::IsItemHovered())
-            ImGuiToolkit::ToolTip("Frames per second");
+        if (ImGui::IsItemHovered()) {
+            Rendering::FrameTiming t = Rendering::manager().frameTiming();
+            sprintf(dummy_str, "Frames per second (target %.2f)\n"
+                               "Update %.1f ms, interface %.1f ms\n"
+                               "Outputs %.1f ms, swap %.1f ms\n"
+                               "Dropped %lu interface frames",
+                    Rendering::manager().frameRate(), t.update, t.interface, t.outputs, t.swap, (unsigned long) t.dropped);
+            ImGuiToolkit::ToolTip(dummy_str);
+        }
     }
 
     if (*p_mode & Metrics_ram) {
@@ -2444,6 +2453,10 @@ void HelperToolbox::Render()
         ImGui::Text ("Applies a real-time GPU fragment shader defined by custom code in OpenGL Shading Language (GLSL). ");
         ImGuiToolkit::ButtonOpenUrl("About GLSL", "https://www.khronos.org/opengl/wiki/OpenGL_Shading_Language", ImVec2(ImGui::GetContentRegionAvail().x, 0));
         ImGuiToolkit::ButtonOpenUrl("Browse shadertoy.com", "https://www.shadertoy.com", ImVec2(ImGui::GetContentRegionAvail().x, 0));
+        ImGui::NextColumn();
+        ImGuiToolkit::Icon(ICON_FILTER_TIMEMACHINE); ImGui::SameLine(0, IMGUI_SAME_LINE);
+        ImGui::Text("Time machine"); ImGui::NextColumn();
+        ImGui::Text ("Keeps the last seconds of the input source and displays them at a playhead that can be moved, slowed down, frozen or reversed (speed and seek of the source).");
 
         ImGui::Columns(1);
         ImGui::PopTextWrapPos();
@@ -3146,6 +3159,10 @@ void SourceController::Render()
                     mediaplayer_active_->setRewindOnDisabled(true);
                 ImGui::EndMenu();
             }
+
+            bool gapless = mediaplayer_active_->gapless();
+            if (ImGui::MenuItem(ICON_FA_CUT "  Gapless cuts", NULL, &gapless ))
+                mediaplayer_active_->setGapless(gapless);
             // always allow for hardware decoding to be disabled
             ImGui::Separator();
             if (ImGui::BeginMenu(ICON_FA_MICROCHIP "  Hardware decoding"))
@@ -3158,6 +3175,24 @@ void SourceController::Render()
                     mediaplayer_active_->setSoftwareDecodingForced(true);
                 ImGui::EndMenu();
             }
+            if (ImGui::BeginMenu(ICON_FA_COMPRESS "  Decode resolution"))
+            {
+                int limit = mediaplayer_active_->decodeLimit();
+                bool option = limit == DECODE_FULL;
+                if (ImGui::MenuItem("Full", "", &option ))
+                    mediaplayer_active_->setDecodeLimit(DECODE_FULL);
+                option = limit == DECODE_AUTO;
+                if (ImGui::MenuItem("Automatic", "", &option ))
+                    mediaplayer_active_->setDecodeLimit(DECODE_AUTO);
+                static int heights[4] = { 1080, 720, 540, 360 };
+                for (int i = 0; i < 4; ++i) {
+                    option = limit == heights[i];
+                    std::string label = "Max " + std::to_string(heights[i]) + "p";
+                    if (ImGui::MenuItem(label.c_str(), "", &option ))
+                        mediaplayer_active_->setDecodeLimit(heights[i]);
+                }
+                ImGui::EndMenu();
+            }
             
 
             ImGui::EndMenu();
@@ -6985,7 +7020,10 @@ void ShaderEditor::Render()
             CloneSource *c = dynamic_cast<CloneSource *>(s);
             // if the current source is a clone
             if ( c != nullptr ) {
+                // first Image Filter in chain of filters
                 FrameBufferFilter *f = c->filter();
+                for (size_t k = 1; f != nullptr && f->type() != FrameBufferFilter::FILTER_IMAGE; ++k)
+                    f = c->filter(k);
                 // if the filter seems to be an Image Filter
                 if (f != nullptr && f->type() == FrameBufferFilter::FILTER_IMAGE ) {
                     i = dynamic_cast<ImageFilter *>(f);
@@ -9157,8 +9195,82 @@ void Navigator::RenderMainPannelSettings()
         else
             ImGui::TextDisabled("Hardware en/decoding unavailable");
 
+        // YUV upload applies to videos opened after change
+        ImGuiToolkit::Indication("If enabled, videos are transfered to the graphics card in their "
+                                 "native YUV format and converted to RGB by the GPU.\n"
+                                 "Applies to videos loaded afterwards.", ICON_FA_EXCHANGE_ALT);
+        ImGui::SameLine(0);
+        ImGuiToolkit::ButtonSwitch( "GPU color conversion", &Settings::application.render.yuv_upload);
+
+        // RAM cache of decoded frames (0 to disable)
+        ImGuiToolkit::Indication("Memory used to keep decoded video frames for "
+                                 "instant stepping, scrubbing and reverse play.", ICON_FA_MEMORY);
+        ImGui::SameLine(0);
+        ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+        if ( ImGui::SliderInt("Frame cache", &Settings::application.render.frame_cache, 0, 4096, "%d MB") )
+            FrameCache::manager().setBudget( Settings::application.render.frame_cache );
+
+        // disk cache of compiled shaders
+        ImGuiToolkit::Indication("Keep the shaders compiled by the graphics driver "
+                                 "to avoid compiling them again at next start.", ICON_FA_MICROCHIP);
+        ImGui::SameLine(0);
+        ImGuiToolkit::ButtonSwitch( "Shader cache", &Settings::application.render.program_cache);
+
+        // graphics memory for frame buffers (of sources, filters, thumbnails)
+        ImGuiToolkit::Indication("Graphics memory for the frame buffers of sources and filters; "
+                                 "frame buffers no longer used are kept to be reused.", ICON_FA_LAYER_GROUP);
+        ImGui::SameLine(0);
+        ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+        ImGui::SliderInt("GPU budget", &Settings::application.render.gpu_budget, 512, 16384, "%d MB");
+        if (ImGui::IsItemHovered()) {
+            static char pool_info[256];
+            FrameBufferPool &pool = FrameBufferPool::manager();
+            snprintf(pool_info, 256, "In use %s, kept %s\nReused %lu / %lu",
+                     BaseToolkit::byte_to_string( pool.allocated() * 1024 ).c_str(),
+                     BaseToolkit::byte_to_string( pool.pooled() * 1024 ).c_str(),
+                     (unsigned long) pool.hits(), (unsigned long) (pool.hits() + pool.misses()) );
+            ImGuiToolkit::ToolTip(pool_info);
+        }
+
+        // number of samples of gaussian blur (radius sets the level of details)
+        ImGuiToolkit::Indication("Quality of the gaussian blur filter; larger blur radius "
+                                 "are computed at lower resolution for the same cost.", ICON_FILTER_BLUR);
+        ImGui::SameLine(0);
+        ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+        ImGui::Combo("Blur quality", &Settings::application.render.blur_quality,
+                     BlurFilter::quality_label, IM_ARRAYSIZE(BlurFilter::quality_label) );
+
+        // compute shaders for neighborhood filters (smooth, sharpen, edge)
+        if ( ShadingProgram::computeSupported() ) {
+            ImGuiToolkit::Indication("Smoothing, sharpening and edge filters are computed by tiles "
+                                     "of pixels sharing their neighbors (faster on large images).", ICON_FA_TH);
+            ImGui::SameLine(0);
+            ImGuiToolkit::ButtonSwitch( "Tiled filters", &Settings::application.render.compute_filters);
+        }
+
+        // intra-frame proxy of media files
+        ImGuiToolkit::Indication("Open the intra-frame proxy of a video (if created) "
+                                 "instead of the original file.", ICON_FA_FILE_VIDEO);
+        ImGui::SameLine(0);
+        ImGuiToolkit::ButtonSwitch( "Media proxy", &Settings::application.source.proxy);
+        ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+        ImGui::Combo("Proxy codec", &Settings::application.source.proxy_codec,
+                     MediaProxy::codec_name, IM_ARRAYSIZE(MediaProxy::codec_name) );
+        ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+        ImGui::Combo("Proxy height", &Settings::application.source.proxy_res,
+                     MediaProxy::resolution_name, IM_ARRAYSIZE(MediaProxy::resolution_name) );
+
         change |= ImGuiToolkit::ButtonSwitch( "Vertical synchronization", &vsync);
 
+        // frame rate of rendering (0 for refresh rate of output monitor)
+        ImGuiToolkit::Indication("Rate of rendering of the session and output windows; "
+                                 "the refresh rate of the monitor of the output window if set to 0.\n"
+                                 "Frames of the interface can be dropped to keep that rate.", ICON_FA_TACHOMETER_ALT);
+        ImGui::SameLine(0);
+        ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+        ImGui::SliderFloat("Frame rate", &Settings::application.render.framerate, 0.f, 240.f,
+                           Settings::application.render.framerate > 0.f ? "%.2f Hz" : "Monitor");
+
 #ifndef NDEBUG
         change |= ImGuiToolkit::ButtonSwitch( "Antialiasing framebuffer", &multi);
 #endif
@@ -66,6 +66,16 @@ void View::draw()
     scene.root()->draw(glm::identity<glm::mat4>(), Rendering::manager().Projection());
 }
 
+void View::updateHidden(float dt)
+{
+    dt_ = dt;
+
+    // only animate the groups of sources (e.g. interpolation of snapshots);
+    // the scene is fully updated when the view is displayed again
+    for (NodeSet::iterator node = scene.ws()->begin(); node != scene.ws()->end(); ++node)
+        (*node)->Node::update( dt_ );
+}
+
 void View::update(float dt)
 {
     dt_ = dt;
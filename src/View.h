@@ -36,6 +36,8 @@ public:
     inline Mode mode () const { return mode_; }
 
     virtual void update (float dt);
+    // update of a view that is not displayed
+    void updateHidden (float dt);
     virtual void draw ();
 
     virtual void zoom (float);
@@ -45,6 +45,7 @@ class MultiFileSource;
 class FrameBufferFilter;
 class PassthroughFilter;
 class DelayFilter;
+class TimeMachineFilter;
 class ResampleFilter;
 class BlurFilter;
 class SharpenFilter;
@@ -115,6 +116,7 @@ public:
     virtual void visit (FrameBufferFilter&) {}
     virtual void visit (PassthroughFilter&) {}
     virtual void visit (DelayFilter&) {}
+    virtual void visit (TimeMachineFilter&) {}
     virtual void visit (ResampleFilter&) {}
     virtual void visit (BlurFilter&) {}
     virtual void visit (SharpenFilter&) {}
@@ -121,5 +121,9 @@
 #define OSC_PORT_RECV_DEFAULT 7000
 #define OSC_PORT_SEND_DEFAULT 7001
 #define OSC_CONFIG_FILE "osc.xml"
+#define MEDIA_CACHE_FILE "media.xml"
+#define MEDIA_PROXY_PATH "proxy"
+#define PROGRAM_CACHE_PATH "programs"
+#define DECODER_CACHE_FILE "decoders.xml"
 
 #endif // VMIX_DEFINES_H
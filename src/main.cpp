@@ -30,6 +30,7 @@
 #include "ControlManager.h"
 #include "Connection.h"
 #include "Metronome.h"
+#include "ImageFilter.h"
 
 #if defined(APPLE)
 extern "C"{
@@ -44,11 +45,11 @@ void prepare()
 {
     Control::manager().update();
     Mixer::manager().update();
-    UserInterface::manager().NewFrame();
 }
 
 void drawScene()
 {
+    UserInterface::manager().NewFrame();
     Mixer::manager().draw();
 }
 
@@ -87,9 +88,18 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "%s: test OK\n", APP_NAME);
                 return 0;
             }
+            else if (argument == "--benchmark" || argument == "-B") {
+                if ( !Rendering::manager().init() ) {
+                    fprintf(stderr, "%s: benchmark Failed\n", APP_NAME);
+                    return 1;
+                }
+                fprintf(stderr, "%s", ImageFilter::benchmark(1280, 720).c_str());
+                fprintf(stderr, "%s", ImageFilter::benchmark(1920, 1080).c_str());
+                return 0;
+            }
             else {
                 fprintf(stderr, "%s: unrecognized option '%s'\n"
-                        "Usage: %s [-V, --version][-T, --test][-C, --clean][FILE]\n",
+                        "Usage: %s [-V, --version][-T, --test][-B, --benchmark][-C, --clean][FILE]\n",
                         APP_NAME, argument.c_str(), APP_NAME);
                 return 1;
             }
@@ -152,8 +162,8 @@ int main(int argc, char *argv[])
 
     // callbacks to draw
     Rendering::manager().pushBackDrawCallback(prepare);
-    Rendering::manager().pushBackDrawCallback(drawScene);
-    Rendering::manager().pushBackDrawCallback(renderGUI);
+    Rendering::manager().pushBackInterfaceCallback(drawScene);
+    Rendering::manager().pushBackInterfaceCallback(renderGUI);
 
     // show all windows
     Rendering::manager().draw();